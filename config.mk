@@ -12,5 +12,10 @@ USE_SAPI=y
 USE_TINYPRINTF=y
 
 DEFINES+=SAPI_USE_INTERRUPTS
+DEFINES+=appTRACE_ENABLE
+DEFINES+=cliTRACE_HOOKS
+DEFINES+=cliMAX_COMMANDS=20
+# Operands of the decimal engine, long enough to reach Karatsuba (decimal.h)
+DEFINES+=cliMAX_NUMBER_LENGTH=80
 
 SRC+=$(wildcard $(PROGRAM_PATH_AND_NAME)/lib/*.c)
\ No newline at end of file
@@ -20,6 +20,16 @@ should be your max number of commands plus one  */
 	#define	cliMAX_COMMANDS					10
 #endif
 
+/* Max amount of parameters a command with typed parameters can declare */
+#ifndef cliMAX_PARAMETERS
+	#define cliMAX_PARAMETERS				8
+#endif
+
+/* Max length of a number parameter, including sign and decimal point */
+#ifndef cliMAX_NUMBER_LENGTH
+	#define cliMAX_NUMBER_LENGTH			24
+#endif
+
 #define configCOMMAND_INT_MAX_OUTPUT_SIZE	1024
 
 #define pdFAIL	( (int)0 )
@@ -28,8 +38,62 @@ should be your max number of commands plus one  */
 #define pdFALSE	( (int)0 )
 #define pdTRUE	   ( (int)1 )
 
+/* Returned by a command that stopped because cancel was requested. It ended
+like with pdFALSE, and pcWriteBuffer holds what it did until then */
+#define cliCANCELLED	( (int)2 )
+
+/* Trace hooks around each command callback. Empty unless cliTRACE_HOOKS is
+defined, then the application implements CLI_TraceCommandStart() and
+CLI_TraceCommandEnd() */
+#ifdef cliTRACE_HOOKS
+	#define traceCLI_COMMAND_START( xCommandIndex )		CLI_TraceCommandStart( xCommandIndex )
+	#define traceCLI_COMMAND_END( xReturn )				CLI_TraceCommandEnd( xReturn )
+#else
+	#define traceCLI_COMMAND_START( xCommandIndex )
+	#define traceCLI_COMMAND_END( xReturn )
+#endif
+
 /*=====[Definitions of public data types]================================================*/
 
+/**
+ *  Types of parameter a command can declare.
+ *  The command interpreter validate and convert each parameter before calling the command.
+ */
+typedef enum
+{
+	cliPARAM_NUMBER,		/**< Decimal number with optional sign and decimal point. Converted to dNumber. */
+	cliPARAM_INTEGER,		/**< Integer number with optional sign. Converted to lInteger. */
+	cliPARAM_KEYWORD,		/**< One of the words in ppcKeywords. Converted to its index in xKeyword. */
+	cliPARAM_STRING,		/**< One word, passed as is. */
+	cliPARAM_VARIADIC		/**< The rest of the command line, passed as is. Only allowed as the last parameter. */
+} CLI_Parameter_Type_t;
+
+/**
+ *  The structure that defines a typed parameter of a command.
+ */
+typedef struct xCOMMAND_LINE_PARAMETER
+{
+	CLI_Parameter_Type_t xType;						/**< Type of the parameter. */
+	double dMin;									/**< Minimum value accepted by cliPARAM_NUMBER and cliPARAM_INTEGER. */
+	double dMax;									/**< Maximum value accepted by cliPARAM_NUMBER and cliPARAM_INTEGER. */
+	uint8_t ucDigits;								/**< Maximum amount of digits accepted by cliPARAM_NUMBER. 0 means no limit. */
+	const char * const * ppcKeywords;				/**< NULL terminated list of words accepted by cliPARAM_KEYWORD. */
+} CLI_Parameter_t;
+
+/**
+ *  The structure where a validated parameter is passed to a command.
+ *  pcString and xStringLength are always loaded, the other fields only for their types.
+ */
+typedef struct xCOMMAND_LINE_ARGUMENT
+{
+	const char *pcString;							/**< Pointer to the parameter inside the command string. Not null terminated, except for cliPARAM_VARIADIC. */
+	int xStringLength;								/**< Length of the parameter. */
+	uint8_t ucDigits;								/**< Amount of digits entered on a cliPARAM_NUMBER. */
+	double dNumber;									/**< Value of a cliPARAM_NUMBER. */
+	long lInteger;									/**< Value of a cliPARAM_INTEGER. */
+	int xKeyword;									/**< Index on ppcKeywords of a cliPARAM_KEYWORD. */
+} CLI_Argument_t;
+
 /* The prototype to which callback functions used to process command line
 commands must comply.  pcWriteBuffer is a buffer into which the output from
 executing the command can be written, xWriteBufferLen is the length, in bytes of
@@ -37,6 +101,11 @@ the pcWriteBuffer buffer, and pcCommandString is the entire string as input by
 the user (from which parameters can be extracted).*/
 typedef int (*pdCOMMAND_LINE_CALLBACK)( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
 
+/* The prototype to which callback functions of commands with typed parameters
+must comply.  pxArguments is an array with the xNumberOfArguments parameters
+already validated and converted, in the same order as they were declared.*/
+typedef int (*pdCOMMAND_LINE_TYPED_CALLBACK)( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
+
 /**
  *  The structure that defines command line commands.
  *  A command line command should be defined by declaring a const structure of this type.
@@ -46,7 +115,9 @@ typedef struct xCOMMAND_LINE_INPUT
 	const char * const pcCommand;							/**< The command that causes pxCommandInterpreter to be executed.  For example "help".  Must be all lower case. */
 	const char * const pcHelpString;						/**< String that describes how to use the command.  Should start with the command itself, and end with "\r\n".  For example "help: Returns a list of all the commands\r\n". */
 	const pdCOMMAND_LINE_CALLBACK pxCommandInterpreter;		/**< A pointer to the callback function that will return the output generated by the command. */
-	int8_t cExpectedNumberOfParameters;						/**< Commands expect a fixed number of parameters, which may be zero. */
+	int8_t cExpectedNumberOfParameters;						/**< Commands expect a fixed number of parameters, which may be zero. With typed parameters, it is the number of elements of pxParameters. */
+	const CLI_Parameter_t * const pxParameters;				/**< Optional array of typed parameters. If NULL, pxCommandInterpreter receive the raw command string. */
+	const pdCOMMAND_LINE_TYPED_CALLBACK pxTypedInterpreter;	/**< Callback used instead of pxCommandInterpreter when pxParameters is not NULL. */
 } CLI_Command_Definition_t;
 
 /*=====[Public functions declarations]===================================================*/
@@ -68,7 +139,12 @@ int CLI_RegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegis
  * xWriteBufferLen must indicate the size, in bytes, of the buffer pointed to
  * by pcWriteBuffer.
  *
- * my_CLIProcessCommand should be called repeatedly until it returns pdFALSE.
+ * my_CLIProcessCommand should be called repeatedly while it returns pdTRUE.
+ * It returns pdFALSE when the command ended, cliCANCELLED when it was cancelled.
+ *
+ * If the command declare typed parameters, they are validated before calling it.
+ * If some of them is invalid, the reason is placed into pcWriteBuffer,
+ * the command is not called and pdFALSE is returned.
  *
  * @param	pcCommandInput
  * @param	pcWriteBuffer
@@ -89,5 +165,58 @@ int CLI_ProcessCommand( const char * const pcCommandInput, char *pcWriteBuffer,
  */
 const char* CLI_GetParameter( const char *pcCommandString, unsigned int uxWantedParameter, int *pxParameterStringLength );
 
+/*
+ * Return pdTRUE if the uxLength characters at pcNumber are a number with the
+ * rules of cliPARAM_NUMBER: optional negative sign, digits and at most one
+ * decimal point, not at the end. For commands that parse their own list of numbers.
+ *
+ * @param	pcNumber		pointer to the number, not necessarily null terminated.
+ * @param	uxLength		characters of the number, at most cliMAX_NUMBER_LENGTH.
+ * @return	pdTRUE if it is a number, pdFALSE if not.
+ */
+int CLI_IsNumber( const char *pcNumber, size_t uxLength );
+
+/*
+ * Request the running command to stop. Can be called from an interrupt.
+ *
+ * A command that return pdTRUE yields, and it is called again later to continue.
+ * Once cancel is requested, it is called one more time, where CLI_IsCancelRequested()
+ * returns pdTRUE: the command must release its state and return cliCANCELLED.
+ * Commands with long loops should also check it inside them.
+ */
+void CLI_RequestCancel( void );
+
+/*
+ * Call a command that yields one more time with cancel requested, so it
+ * releases its state. The request is seen only by this call, the one of
+ * CLI_RequestCancel() is neither set nor cleared.
+ *
+ * @param	pcCommandInput, pcWriteBuffer, xWriteBufferLen	as CLI_ProcessCommand().
+ * @return	what the command returns, cliCANCELLED if it stopped.
+ */
+int CLI_CancelCommand( const char * const pcCommandInput, char *pcWriteBuffer, size_t xWriteBufferLen );
+
+/*
+ * Return pdTRUE if the running command has to stop.
+ *
+ * @return	pdTRUE if cancel was requested, pdFALSE if not.
+ */
+int CLI_IsCancelRequested( void );
+
+/*
+ * Clear the cancel request. Must be called before starting a new command.
+ */
+void CLI_ClearCancel( void );
+
+/*
+ * Hooks called before and after a command callback, when cliTRACE_HOOKS is
+ * defined. Implemented by the application, the library only calls them.
+ *
+ * @param	xCommandIndex	index of the command on the registered commands.
+ * @param	xReturn			value returned by the callback.
+ */
+void CLI_TraceCommandStart( int xCommandIndex );
+void CLI_TraceCommandEnd( int xReturn );
+
 
 #endif /* MY_CLI_H_ */
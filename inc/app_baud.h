@@ -0,0 +1,90 @@
+/*
+ * app_baud.h
+ *
+ *  Negotiation of the baud rate of the command line at runtime.
+ *  The new rate is used after the answer of "baud" is sent, and it is kept
+ *  only if the line baudCONFIRMATION arrives at the new rate before the
+ *  timeout. Otherwise the previous rate is restored.
+ */
+
+#ifndef APP_BAUD_H_
+#define APP_BAUD_H_
+
+/*=====[Includes]=========================================================================*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*=====[Definitions and macros]===========================================================*/
+
+#define baudDEFAULT_RATE		115200			/**< Rate after reset */
+#define baudMIN_RATE			9600
+#define baudMAX_RATE			12000000		/**< Peripheral clock / 16 of the UART, and max of the USB bridge */
+
+#ifndef baudTIMEOUT_MS
+	#define baudTIMEOUT_MS		2000			/**< Time to receive the confirmation at the new rate */
+#endif
+
+#define baudCONFIRMATION		"baud ok"		/**< Line the client sends at the new rate */
+
+
+/*=====[Definitions of public data types]================================================*/
+
+/**
+ * Function that reconfigure the UART to a new rate.
+ * It must wait until the bytes already written are sent.
+ */
+typedef void (*Baud_SetRate_t)( uint32_t ulRate );
+
+
+/*=====[Public functions declarations]===================================================*/
+
+/*
+ * Set the function that change the rate of the UART, and the rate in use.
+ * @param	pxSetRate		function to change the rate.
+ * @param	ulRate			rate configured.
+ * @param	ulTimeoutTicks	baudTIMEOUT_MS in ticks of the clock given to app_baudUpdate.
+ */
+void app_baudInit( Baud_SetRate_t pxSetRate, uint32_t ulRate, uint32_t ulTimeoutTicks );
+
+/*
+ * Ask to change the rate. The change is done on the next app_baudUpdate.
+ * @param	ulRate		new rate.
+ * @return	false if a negotiation is already in progress.
+ */
+bool app_baudRequest( uint32_t ulRate );
+
+/*
+ * Return the rate in use.
+ */
+uint32_t app_baudGetRate( void );
+
+/*
+ * Return true while the new rate is waiting the confirmation.
+ * Lines received meanwhile must be given to app_baudConfirm.
+ */
+bool app_baudIsConfirming( void );
+
+/*
+ * Return true from the request until the new rate is confirmed or the
+ * previous one restored. Answers written meanwhile may be lost.
+ */
+bool app_baudIsPending( void );
+
+/*
+ * Check a line received while confirming.
+ * @param	pcLine		line received, null terminated.
+ * @return	true if it is the confirmation, then the new rate is kept.
+ */
+bool app_baudConfirm( const char *pcLine );
+
+/*
+ * Do the change requested, or restore the previous rate if the confirmation
+ * did not arrive in time. Call it after the answer of "baud" was written.
+ * @param	ulNow		current time, in ticks.
+ * @return	message to write to the client, or NULL.
+ */
+const char* app_baudUpdate( uint32_t ulNow );
+
+#endif /* APP_BAUD_H_ */
@@ -0,0 +1,76 @@
+/*
+ * app_stats.h
+ *
+ *  Running statistics of a stream of samples, with constant memory.
+ */
+
+#ifndef APP_STATS_H_
+#define APP_STATS_H_
+
+/*=====[Includes]=========================================================================*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*=====[Definitions and macros]===========================================================*/
+
+#define statsQUANTILES		3			/**< Amount of quantiles estimated: 0.5, 0.9 and 0.99 */
+
+
+/*=====[Definitions of public data types]================================================*/
+
+/**
+ * Aggregates of the samples received since the last reset.
+ */
+typedef struct xSTATS_SUMMARY
+{
+	uint32_t ulCount;							/**< Samples absorbed */
+	uint32_t ulRejected;						/**< Lines that were not a number */
+	double dMean;								/**< Mean of the samples */
+	double dVariance;							/**< Sample variance, 0 with less than 2 samples */
+	double dMin;								/**< Minimum sample */
+	double dMax;								/**< Maximum sample */
+	double dQuantileProbability[statsQUANTILES];	/**< Probability of each quantile estimated */
+	double dQuantile[statsQUANTILES];			/**< Approximate quantiles (P-square algorithm) */
+} Stats_Summary_t;
+
+
+/*=====[Public functions declarations]===================================================*/
+
+/*
+ * Discard all the samples absorbed.
+ */
+void app_statsReset( void );
+
+/*
+ * Absorb one sample on the running aggregates.
+ * @param	dSample		value of the sample.
+ */
+void app_statsPush( double dSample );
+
+/*
+ * Absorb a sample written as text. If it is not a number it is counted as rejected.
+ * @param	pcSample	string with the sample, null terminated.
+ */
+void app_statsPushString( const char *pcSample );
+
+/*
+ * Load the current aggregates.
+ * @param	pxSummary	where the aggregates are loaded.
+ */
+void app_statsGetSummary( Stats_Summary_t *pxSummary );
+
+/*
+ * Enter or leave stream mode. On stream mode each line received is a sample,
+ * and it is absorbed without processing it as a command.
+ * @param	bStreaming	true to enter stream mode, false to leave it.
+ */
+void app_statsSetStreaming( bool bStreaming );
+
+/*
+ * Return true while stream mode is active.
+ */
+bool app_statsIsStreaming( void );
+
+#endif /* APP_STATS_H_ */
@@ -0,0 +1,119 @@
+/*
+ * app_trace.h
+ *
+ *  Binary trace of timestamped events on a fixed size ring.
+ *  Records are written lock free from interrupts and main loop, the oldest
+ *  ones are overwritten. Define appTRACE_ENABLE to record, otherwise the
+ *  trace macros are empty.
+ */
+
+#ifndef APP_TRACE_H_
+#define APP_TRACE_H_
+
+/*=====[Includes]=========================================================================*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*=====[Definitions and macros]===========================================================*/
+
+/* Amount of records of the ring. Must be power of 2 */
+#ifndef traceBUFFER_SIZE
+	#define traceBUFFER_SIZE		256
+#endif
+
+/* Timestamp of the records: DWT cycle counter of the Cortex-M4 */
+#ifndef traceTIMESTAMP
+	#define traceTIMESTAMP()		( *(volatile uint32_t *)0xE0001004 )
+#endif
+
+
+/*=====[Definitions of public data types]================================================*/
+
+/**
+ * Events recorded.
+ */
+typedef enum
+{
+	traceEV_RX = 0,				/**< UART_USBOnRx entry. Argument: byte received */
+	traceEV_STATE,				/**< app_FSM state change. Argument: new state */
+	traceEV_CMD_START,			/**< Command callback called. Argument: index of the command */
+	traceEV_CMD_END,			/**< Command callback returned. Argument: value returned */
+	traceEV_TX_START,			/**< Start writing to UART. Argument: length */
+	traceEV_TX_END,				/**< End writing to UART. Argument: length */
+	traceEV_OVERRUN				/**< Byte lost, UART ring buffer full. Argument: byte lost */
+} Trace_Event_t;
+
+/**
+ * One record of the trace. 8 bytes.
+ */
+typedef struct xTRACE_RECORD
+{
+	uint32_t ulTimestamp;		/**< Cycles when the event happened */
+	uint8_t ucEvent;			/**< Trace_Event_t */
+	uint8_t ucReserved;
+	uint16_t usArgument;		/**< Depends on the event */
+} Trace_Record_t;
+
+
+/*=====[Public variables declarations]===================================================*/
+
+extern Trace_Record_t xTraceBuffer[traceBUFFER_SIZE];	/**< Ring of records */
+extern uint32_t ulTraceHead;							/**< Total records written, the ring index is its lower bits */
+extern volatile bool bTracePaused;						/**< While true nothing is recorded */
+
+
+/*=====[Public functions declarations]===================================================*/
+
+/*
+ * Enable the cycle counter used as timestamp, and clear the ring.
+ */
+void app_traceInit( void );
+
+/*
+ * Discard all the records.
+ */
+void app_traceClear( void );
+
+/*
+ * Stop or resume recording. The ring must be paused while it is read.
+ * @param	bPause	true to stop recording.
+ */
+void app_tracePause( bool bPause );
+
+/*
+ * Return the amount of records stored, at most traceBUFFER_SIZE.
+ */
+uint32_t app_traceCount( void );
+
+/*
+ * Return the ulIndex'th record stored, starting on the oldest.
+ * @param	ulIndex	index, lower than app_traceCount().
+ */
+const Trace_Record_t* app_traceGet( uint32_t ulIndex );
+
+/*
+ * Write one record. Inlined so each event costs a few cycles:
+ * one atomic increment of the head and three stores.
+ */
+static inline void app_traceRecord( Trace_Event_t xEvent, uint16_t usArgument )
+{
+	Trace_Record_t *pxRecord;
+
+	if( bTracePaused )
+		return;
+
+	pxRecord = &xTraceBuffer[__atomic_fetch_add( &ulTraceHead, 1, __ATOMIC_RELAXED ) & ( traceBUFFER_SIZE - 1 )];
+	pxRecord->ulTimestamp = traceTIMESTAMP();
+	pxRecord->ucEvent = (uint8_t)xEvent;
+	pxRecord->usArgument = usArgument;
+}
+
+#ifdef appTRACE_ENABLE
+	#define traceRECORD( xEvent, usArgument )			app_traceRecord( xEvent, (uint16_t)( usArgument ) )
+#else
+	#define traceRECORD( xEvent, usArgument )
+#endif
+
+#endif /* APP_TRACE_H_ */
@@ -0,0 +1,122 @@
+/*
+ * decimal.h
+ *
+ *  Arbitrary precision decimal numbers.
+ *  Numbers are stored as limbs of 4 decimal digits taken from a fixed arena, no heap is used.
+ *  The arena is released all at once with Decimal_Reset(), so results must be used
+ *  (formatted) before the next reset.
+ */
+
+#ifndef DECIMAL_H_
+#define DECIMAL_H_
+
+/*=====[Includes]=========================================================================*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*=====[Definitions and macros]===========================================================*/
+
+#define decimalBASE						10000		/**< Value of one limb */
+#define decimalBASE_DIGITS				4			/**< Decimal digits stored on one limb */
+
+/* Amount of limbs available to store operands, results and temporal values */
+#ifndef decimalARENA_LIMBS
+	#define decimalARENA_LIMBS				512
+#endif
+
+/* Operands with at least this amount of limbs are multiplied with Karatsuba
+instead of the schoolbook algorithm. The commands accept operands of
+cliMAX_NUMBER_LENGTH (80) characters, up to 20 limbs, so products of
+operands with more than 28 digits take this path */
+#ifndef decimalKARATSUBA_THRESHOLD
+	#define decimalKARATSUBA_THRESHOLD		8
+#endif
+
+/* Amount of limbs after the decimal point of a division result (truncated) */
+#ifndef decimalDIV_LIMBS
+	#define decimalDIV_LIMBS				5
+#endif
+
+
+/*=====[Definitions of public data types]================================================*/
+
+/**
+ * Result of decimal operations.
+ */
+typedef enum
+{
+	decimalOK = 0,					/**< Operation done */
+	decimalERR_SYNTAX,				/**< String is not a decimal number */
+	decimalERR_ARENA,				/**< Not enough limbs left on the arena */
+	decimalERR_DIV_ZERO,			/**< Division by zero */
+	decimalERR_BUFFER				/**< Output buffer too small */
+} Decimal_Status_t;
+
+/**
+ * A decimal number.
+ * Value is (-1)^bNegative * sum( pusLimbs[i] * 10000^i ) / 10000^usScale.
+ */
+typedef struct xDECIMAL
+{
+	uint16_t *pusLimbs;				/**< Limbs of the number, least significant first. Taken from the arena. */
+	uint16_t usLength;				/**< Amount of limbs used. Zero is stored with length 0. */
+	uint16_t usScale;				/**< Amount of limbs after the decimal point. */
+	bool bNegative;					/**< Sign of the number. */
+} Decimal_t;
+
+
+/*=====[Public functions declarations]===================================================*/
+
+/**
+ * Release all the limbs taken from the arena.
+ * All the Decimal_t created before are invalid after calling it.
+ */
+void Decimal_Reset( void );
+
+/**
+ * Create a decimal number from a string with optional negative sign and decimal point.
+ *
+ * @param	pxNumber		where the number is created.
+ * @param	pcString		string with the number, not necessarily null terminated.
+ * @param	uxLength		length of pcString.
+ * @return	decimalOK, decimalERR_SYNTAX or decimalERR_ARENA.
+ */
+Decimal_Status_t Decimal_Parse( Decimal_t *pxNumber, const char *pcString, size_t uxLength );
+
+/**
+ * pxResult = pxA + pxB.
+ * @return	decimalOK or decimalERR_ARENA.
+ */
+Decimal_Status_t Decimal_Add( Decimal_t *pxResult, const Decimal_t *pxA, const Decimal_t *pxB );
+
+/**
+ * pxResult = pxA - pxB.
+ * @return	decimalOK or decimalERR_ARENA.
+ */
+Decimal_Status_t Decimal_Sub( Decimal_t *pxResult, const Decimal_t *pxA, const Decimal_t *pxB );
+
+/**
+ * pxResult = pxA * pxB. Exact.
+ * @return	decimalOK or decimalERR_ARENA.
+ */
+Decimal_Status_t Decimal_Mul( Decimal_t *pxResult, const Decimal_t *pxA, const Decimal_t *pxB );
+
+/**
+ * pxResult = pxA / pxB, truncated to decimalDIV_LIMBS limbs after the decimal point.
+ * @return	decimalOK, decimalERR_DIV_ZERO or decimalERR_ARENA.
+ */
+Decimal_Status_t Decimal_Div( Decimal_t *pxResult, const Decimal_t *pxA, const Decimal_t *pxB );
+
+/**
+ * Write the number as a null terminated string, without trailing zeros after the decimal point.
+ *
+ * @param	pxNumber		number to write.
+ * @param	pcBuffer		where the string is written.
+ * @param	xBufferLen		size of pcBuffer.
+ * @return	decimalOK or decimalERR_BUFFER.
+ */
+Decimal_Status_t Decimal_Format( const Decimal_t *pxNumber, char *pcBuffer, size_t xBufferLen );
+
+#endif /* DECIMAL_H_ */
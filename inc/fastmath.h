@@ -0,0 +1,144 @@
+/*
+ * fastmath.h
+ *
+ *  Elementary functions in single precision, computed with our own kernels
+ *  instead of libm: table with interpolation, CORDIC and polynomials.
+ *  Only float operations are used, so they run on the FPU of the Cortex-M4
+ *  instead of the soft double of newlib.
+ *
+ *  Each function has two modes:
+ *  - fastmathFAST: the cheapest kernel, with the error bounds listed below.
+ *  - fastmathPRECISE: close to the float resolution.
+ *
+ *  Maximum errors measured against double libm (host, 10^6 random samples):
+ *
+ *  function    domain                  fastmathFAST            fastmathPRECISE
+ *  sqrt        x >= 0                  rel 1.8e-3              rel 8.8e-8
+ *  sin, cos    |x| <= 8192             abs 4.8e-6              abs 7.7e-8
+ *  atan2       any y, x                abs 4.9e-4              abs 6.4e-7
+ *  exp         -87.3 <= x <= 88.7      rel 1.0e-4              rel 8.1e-8
+ *  log         0.5 <= x <= 2           abs 3.0e-5              abs 5.6e-8
+ *  log         other x > 0             rel 2.9e-5              rel 1.0e-7
+ *
+ *  sin and cos lose accuracy with arguments above 8192 (range reduction).
+ *
+ *  Cycles per value on FastMath_Vector(), arguments on the normal range.
+ *  ESTIMATES, not measured on the board: counted for the Cortex-M4F from the
+ *  instruction timings of its reference manual (FPU add and multiply 1,
+ *  divide 14, compare and branch 3, load 2). The help of "modo" says so too:
+ *
+ *  function    fastmathFAST    fastmathPRECISE
+ *  sqrt        20              30
+ *  sin, cos    46              41
+ *  atan2       185             250
+ *  exp         38              48
+ *  log         52              56
+ *
+ *  The precise sine is not slower than the table: the range reduction costs
+ *  the same, and the polynomial replaces the two loads and the interpolation.
+ *  "bench" on the board times whole commands, parsing and printing included.
+ *  To replace the estimates, run "bench 1000 sqrt 2" and "bench 1000 sqrt 2 2 2 2
+ *  2 2 2 2" on each mode: a seventh of the difference of the mean cycles is
+ *  the cost of one more value, its parsing and printing included.
+ */
+
+#ifndef FASTMATH_H_
+#define FASTMATH_H_
+
+/*=====[Includes]=========================================================================*/
+#include <stddef.h>
+#include <stdint.h>
+
+
+/*=====[Definitions and macros]===========================================================*/
+
+#define fastmathTRIG_MAX_ARGUMENT		8192.0f		/**< Max |x| of sin and cos with the error bounds above */
+#define fastmathEXP_MIN_ARGUMENT		-87.3365479f	/**< exp returns 0 below */
+#define fastmathEXP_MAX_ARGUMENT		88.7228394f		/**< exp returns infinite above */
+
+/* Points of the sine table on a quarter of turn. Must be power of 2 */
+#define fastmathSIN_TABLE_SIZE			256
+
+/* CORDIC iterations of atan2 on each mode */
+#define fastmathCORDIC_FAST_ITERATIONS		12
+#define fastmathCORDIC_PRECISE_ITERATIONS	16
+
+
+/*=====[Definitions of public data types]================================================*/
+
+/**
+ * Accuracy/speed trade off.
+ */
+typedef enum
+{
+	fastmathFAST = 0,				/**< Cheapest kernel */
+	fastmathPRECISE					/**< Error close to float resolution */
+} FastMath_Mode_t;
+
+/**
+ * Functions of one argument, for FastMath_Vector().
+ */
+typedef enum
+{
+	fastmathSQRT = 0,
+	fastmathSIN,
+	fastmathCOS,
+	fastmathEXP,
+	fastmathLOG
+} FastMath_Function_t;
+
+
+/*=====[Public functions declarations]===================================================*/
+
+/**
+ * Square root. Fast: inverse square root estimate and one Newton iteration.
+ * Precise: two Newton iterations and a final correction.
+ * @return	NaN if fX < 0.
+ */
+float FastMath_Sqrt( float fX, FastMath_Mode_t xMode );
+
+/**
+ * Sine. Fast: table of a quarter of sine with linear interpolation.
+ * Precise: minimax polynomial on [-pi/4, pi/4].
+ */
+float FastMath_Sin( float fX, FastMath_Mode_t xMode );
+
+/**
+ * Cosine. Same kernels than FastMath_Sin().
+ */
+float FastMath_Cos( float fX, FastMath_Mode_t xMode );
+
+/**
+ * Angle of the point (fX, fY), in [-pi, pi]. CORDIC on vectoring mode.
+ * Precise mode adds more iterations and the residual angle.
+ * @return	0 if both are 0.
+ */
+float FastMath_Atan2( float fY, float fX, FastMath_Mode_t xMode );
+
+/**
+ * Exponential. Reduced to exp(r) * 2^k with |r| <= ln(2)/2.
+ * Fast: polynomial of degree 3. Precise: degree 7.
+ */
+float FastMath_Exp( float fX, FastMath_Mode_t xMode );
+
+/**
+ * Natural logarithm. Reduced to log(m) + e * ln(2) with m in [sqrt(2)/2, sqrt(2)).
+ * Fast: polynomial of degree 3 on s = (m - 1) / (m + 1). Precise: degree 7.
+ * @return	NaN if fX < 0, -infinite if fX is 0.
+ */
+float FastMath_Log( float fX, FastMath_Mode_t xMode );
+
+/**
+ * Apply one function to uxCount values. The mode and function are resolved
+ * once, and each kernel runs on a tight loop.
+ * @param	pfOut		results, may be the same array than pfIn.
+ */
+void FastMath_Vector( FastMath_Function_t xFunction, FastMath_Mode_t xMode, const float *pfIn, float *pfOut, size_t uxCount );
+
+/**
+ * FastMath_Atan2() of uxCount pairs of values.
+ * @param	pfOut		results, may be the same array than pfY or pfX.
+ */
+void FastMath_Atan2Vector( FastMath_Mode_t xMode, const float *pfY, const float *pfX, float *pfOut, size_t uxCount );
+
+#endif /* FASTMATH_H_ */
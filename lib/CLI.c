@@ -8,7 +8,9 @@
 /*=====[Includes]===========================================================*/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <assert.h>
 #include "CLI.h"
 
@@ -20,6 +22,18 @@
 #define pdFALSE	( (int)0 )
 #define pdTRUE	( (int)1 )
 
+/*=====[Enumerations]=======================================================*/
+
+/**
+ * Enumerate flags for validation numbers.
+ * This flags are used on private functions prvValidateNumber and prvParseArguments.
+ */
+enum Validation_e {
+	NON_NUMERIC = 0x0,		/**< Flag for non numeric */
+	OVERFLOW	= 0x1,		/**< Flag for overflow  */
+	NUMERIC		= 0x2		/**< Flag for numeric */
+};
+
 /*=====[Callback functions]================================================*/
 
 /*
@@ -47,6 +61,29 @@ static int prvHelpCommand( 	char *pcWriteBuffer,
  */
 static int8_t prvGetNumberOfParameters( const char *pcCommandString	);
 
+/*
+ * Take a string and return if it is a valid number or not, and if it fit the requirements.
+ * @param	pcNumber		pointer to string that contains the number to validate.
+ * @param	uxNumber		size of number to validate.
+ * @param	xDecimalPoint	pdTRUE if a decimal point is accepted.
+ * @param	ucMaxDigits		max amount of digits accepted, 0 if no limit.
+ * @param	pucDigits		pointer to store the amount of digits found.
+ * @return	return a flag type Validation_e. NON_NUMERIC, OVERFLOW or NUMERIC.
+ */
+static int prvValidateNumber( const char* pcNumber, size_t uxNumber, int xDecimalPoint, uint8_t ucMaxDigits, uint8_t *pucDigits );
+
+/*
+ * Validate and convert the parameters of a command with typed parameters.
+ * If fail, then a string is saved on pcWriteBuffer specifying the motive.
+ * @param	pxCommand		Command with the parameters declaration.
+ * @param	pcCommandString	String with command and parameters.
+ * @param	pxArguments		Array to store the parameters converted. Must have cExpectedNumberOfParameters elements.
+ * @param	pcWriteBuffer	Pointer output buffer string.
+ * @param	xWriteBufferLen	Size of output buffer.
+ * @return	return pdPASS if all parameters are valid, and pdFAIL if at least one is invalid.
+ */
+static int prvParseArguments( const CLI_Command_Definition_t *pxCommand, const char *pcCommandString, CLI_Argument_t *pxArguments, char *pcWriteBuffer, size_t xWriteBufferLen );
+
 
 /*=====[Private global variables definition]=====================================*/
 
@@ -59,7 +96,9 @@ static const CLI_Command_Definition_t xHelpCommand =
 	"help",
 	"\r\nhelp:\r\n Lista todos los comandos registrados\r\n\r\n",
 	prvHelpCommand,
-	0
+	0,
+	NULL,
+	NULL
 };
 
 /*
@@ -68,6 +107,17 @@ static const CLI_Command_Definition_t xHelpCommand =
  */
 static const CLI_Command_Definition_t* xRegisteredCommands[cliMAX_COMMANDS] = {&xHelpCommand, 0};
 
+/*
+ * Cancellation token of the running command.
+ * Set from interrupts, so it must be volatile.
+ */
+static volatile int xCancelRequested = pdFALSE;
+
+/*
+ * Calls made by CLI_CancelCommand() in progress. Only the main loop uses it.
+ */
+static int xCancelCalls = 0;
+
 
 /*=====[Private callback implementation]===================================*/
 
@@ -81,6 +131,13 @@ static int prvHelpCommand( char *pcWriteBuffer, size_t xWriteBufferLen, const ch
 	/* If no command found, an empty string must be returned */
 	*pcWriteBuffer = '\0';
 
+	/* If cancelled, start again from the first command next time */
+	if( CLI_IsCancelRequested() )
+	{
+		loop = 0;
+		return cliCANCELLED;
+	}
+
 	/* Find next registered command */
 	while( ( xRegisteredCommands[loop] == NULL ) && ( loop < cliMAX_COMMANDS ) )
 		loop++;
@@ -149,6 +206,140 @@ static int8_t prvGetNumberOfParameters( const char *pcCommandString )
 }
 
 
+/*-----------------------------------------------------------*/
+
+static int prvValidateNumber( const char* pcNumber, size_t uxNumber, int xDecimalPoint, uint8_t ucMaxDigits, uint8_t *pucDigits )
+{
+	int xPointFound = pdFALSE;
+	uint8_t ucDigits = 0;
+
+	*pucDigits = 0;
+
+	/* Check if no overflow size number entered */
+	if( uxNumber > cliMAX_NUMBER_LENGTH )
+		return OVERFLOW;
+
+	/* Check if negative */
+	if( ( uxNumber > 0 ) && ( *pcNumber == '-' ) )
+	{
+		pcNumber++;
+		uxNumber--;
+	}
+
+	for( ; uxNumber > 0 ; uxNumber--, pcNumber++ )
+	{
+		/* Check only one decimal point entered */
+		if( ( *pcNumber == '.' ) && xDecimalPoint && !xPointFound )
+			xPointFound = pdTRUE;
+		/* Check character is numeric */
+		else if( isdigit( (unsigned char)*pcNumber ) != 0 )
+			ucDigits++;
+		else
+			return NON_NUMERIC;
+	}
+
+	/* At least one digit, and must not finish with point */
+	if( ( ucDigits == 0 ) || ( pcNumber[-1] == '.' ) )
+		return NON_NUMERIC;
+
+	*pucDigits = ucDigits;
+
+	/* If number larger than expected */
+	if( ( ucMaxDigits != 0 ) && ( ucDigits > ucMaxDigits ) )
+		return OVERFLOW;
+
+	return NUMERIC;
+}
+/*-----------------------------------------------------------*/
+
+static int prvParseArguments( const CLI_Command_Definition_t *pxCommand, const char *pcCommandString, CLI_Argument_t *pxArguments, char *pcWriteBuffer, size_t xWriteBufferLen )
+{
+	const CLI_Parameter_t *pxParameter;
+	CLI_Argument_t *pxArgument;
+	char cNumber[cliMAX_NUMBER_LENGTH + 1];
+	int xValidation = NUMERIC;
+	int loop, xKeyword;
+
+	for( loop = 0 ; ( loop < pxCommand->cExpectedNumberOfParameters ) && ( xValidation == NUMERIC ) ; loop++ )
+	{
+		pxParameter = &pxCommand->pxParameters[loop];
+		pxArgument = &pxArguments[loop];
+
+		memset( pxArgument, 0, sizeof( CLI_Argument_t ) );
+		pxArgument->pcString = CLI_GetParameter( pcCommandString, loop + 1, &pxArgument->xStringLength );
+
+		switch( pxParameter->xType )
+		{
+			case cliPARAM_NUMBER:
+			case cliPARAM_INTEGER:
+				xValidation = prvValidateNumber( pxArgument->pcString, pxArgument->xStringLength, pxParameter->xType == cliPARAM_NUMBER, pxParameter->ucDigits, &pxArgument->ucDigits );
+				if( xValidation != NUMERIC )
+					break;
+
+				/* copy parameter to null terminate it, and convert it */
+				memcpy( cNumber, pxArgument->pcString, pxArgument->xStringLength );
+				cNumber[pxArgument->xStringLength] = '\0';
+
+				if( pxParameter->xType == cliPARAM_NUMBER )
+				{
+					pxArgument->dNumber = strtod( cNumber, NULL );
+				}
+				else
+				{
+					pxArgument->lInteger = strtol( cNumber, NULL, 10 );
+					pxArgument->dNumber = (double)pxArgument->lInteger;
+				}
+
+				if( ( pxArgument->dNumber < pxParameter->dMin ) || ( pxArgument->dNumber > pxParameter->dMax ) )
+					xValidation = OVERFLOW;
+				break;
+
+			case cliPARAM_KEYWORD:
+				xValidation = NON_NUMERIC;
+				for( xKeyword = 0 ; pxParameter->ppcKeywords[xKeyword] != NULL ; xKeyword++ )
+				{
+					if( ( strncmp( pxArgument->pcString, pxParameter->ppcKeywords[xKeyword], pxArgument->xStringLength ) == 0 ) &&
+						( pxParameter->ppcKeywords[xKeyword][pxArgument->xStringLength] == '\0' ) )
+					{
+						pxArgument->xKeyword = xKeyword;
+						xValidation = NUMERIC;
+						break;
+					}
+				}
+				if( xValidation != NUMERIC )
+				{
+					snprintf( pcWriteBuffer, xWriteBufferLen, "Opción no válida: %.*s\r\n", pxArgument->xStringLength, pxArgument->pcString );
+					return pdFAIL;
+				}
+				break;
+
+			case cliPARAM_VARIADIC:
+				/* The rest of the command line */
+				pxArgument->xStringLength = strlen( pxArgument->pcString );
+				break;
+
+			case cliPARAM_STRING:
+			default:
+				break;
+		}
+	}
+
+	/* if some of them is not valid, then report error and why */
+	if( xValidation == NON_NUMERIC )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "Ingrese un número correcto\r\n" );
+		return pdFAIL;
+	}
+	else if( xValidation == OVERFLOW )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "El número excede el permitido\r\n" );
+		return pdFAIL;
+	}
+
+	return pdPASS;
+}
+
+
 /*=====[Public functions implementation]===================================*/
 
 int CLI_RegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegister )
@@ -159,6 +350,11 @@ int CLI_RegisterCommand( const CLI_Command_Definition_t * const pxCommandToRegis
 	/* Check the parameter is not NULL. */
 	assert( pxCommandToRegister );
 
+	/* Typed parameters are converted on an array of cliMAX_PARAMETERS elements */
+	if( ( pxCommandToRegister->pxParameters != NULL ) &&
+		( ( pxCommandToRegister->cExpectedNumberOfParameters < 0 ) || ( pxCommandToRegister->cExpectedNumberOfParameters > cliMAX_PARAMETERS ) ) )
+		return pdFAIL;
+
 	/* Find an empty place to register the command */
 	for(loop = 0; loop < cliMAX_COMMANDS ; loop++)
 	{
@@ -189,6 +385,9 @@ int CLI_ProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer,
 	int loop;
 	const char *pcRegisteredCommandString;
 	size_t xCommandStringLength;
+	const CLI_Command_Definition_t *pxCommand;
+	CLI_Argument_t xArguments[cliMAX_PARAMETERS];
+	int8_t cParameters;
 
 	/* Note:  This function is not re-entrant.  It must not be called from more
 	thank one task. */
@@ -213,9 +412,22 @@ int CLI_ProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer,
 					then there could be a variable number of parameters and no
 					check is made. */
 
-					if( xRegisteredCommands[loop]->cExpectedNumberOfParameters >= 0 )
+					pxCommand = xRegisteredCommands[loop];
+
+					if( pxCommand->cExpectedNumberOfParameters >= 0 )
 					{
-						if( prvGetNumberOfParameters( pcCommandInput ) != xRegisteredCommands[loop]->cExpectedNumberOfParameters )
+						cParameters = prvGetNumberOfParameters( pcCommandInput );
+
+						/* A variadic parameter takes all the words left, but at least one */
+						if( ( pxCommand->pxParameters != NULL ) && ( pxCommand->cExpectedNumberOfParameters > 0 ) &&
+							( pxCommand->pxParameters[pxCommand->cExpectedNumberOfParameters - 1].xType == cliPARAM_VARIADIC ) )
+						{
+							if( cParameters < pxCommand->cExpectedNumberOfParameters )
+							{
+								xReturn = pdFALSE;
+							}
+						}
+						else if( cParameters != pxCommand->cExpectedNumberOfParameters )
 						{
 							xReturn = pdFALSE;
 						}
@@ -232,10 +444,25 @@ int CLI_ProcessCommand( const char * const pcCommandInput, char * pcWriteBuffer,
 		was incorrect. */
 		snprintf( pcWriteBuffer, xWriteBufferLen, "Incorrect command parameter(s).  Enter \"help\" to view a list of available commands.\r\n\r\n" );
 	}
+	else if( ( loop != cliMAX_COMMANDS ) && ( pxCommand->pxParameters != NULL ) )
+	{
+		/* Validate and convert parameters, and only if all of them are correct
+		call the callback function that is registered to this command. */
+		if( prvParseArguments( pxCommand, pcCommandInput, xArguments, pcWriteBuffer, xWriteBufferLen ) == pdPASS )
+		{
+			traceCLI_COMMAND_START( loop );
+			xReturn = pxCommand->pxTypedInterpreter( pcWriteBuffer, xWriteBufferLen, xArguments, pxCommand->cExpectedNumberOfParameters );
+			traceCLI_COMMAND_END( xReturn );
+		}
+		else
+			xReturn = pdFALSE;
+	}
 	else if( loop != cliMAX_COMMANDS )
 	{
 		/* Call the callback function that is registered to this command. */
-		xReturn = xRegisteredCommands[loop]->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+		traceCLI_COMMAND_START( loop );
+		xReturn = pxCommand->pxCommandInterpreter( pcWriteBuffer, xWriteBufferLen, pcCommandInput );
+		traceCLI_COMMAND_END( xReturn );
 	}
 	else
 	{
@@ -304,3 +531,41 @@ const char* CLI_GetParameter( const char *pcCommandString, unsigned int uxWanted
 }
 /*-----------------------------------------------------------*/
 
+int CLI_IsNumber( const char *pcNumber, size_t uxLength )
+{
+	uint8_t ucDigits;
+
+	return ( prvValidateNumber( pcNumber, uxLength, pdTRUE, 0, &ucDigits ) == NUMERIC ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void CLI_RequestCancel( void )
+{
+	xCancelRequested = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+int CLI_CancelCommand( const char * const pcCommandInput, char *pcWriteBuffer, size_t xWriteBufferLen )
+{
+	int xReturn;
+
+	xCancelCalls++;
+	xReturn = CLI_ProcessCommand( pcCommandInput, pcWriteBuffer, xWriteBufferLen );
+	xCancelCalls--;
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+int CLI_IsCancelRequested( void )
+{
+	return ( xCancelRequested || ( xCancelCalls > 0 ) ) ? pdTRUE : pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+void CLI_ClearCancel( void )
+{
+	xCancelRequested = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
@@ -0,0 +1,701 @@
+/*
+ * decimal.c
+ *
+ *  Arbitrary precision decimal numbers stored on limbs of base 10000.
+ */
+
+/*=====[Includes]===========================================================*/
+
+#include <string.h>
+#include "decimal.h"
+
+
+/*=====[Private functions declarations]=====================================*/
+
+/*
+ * Take uxLimbs limbs from the arena.
+ * @param	uxLimbs		amount of limbs wanted.
+ * @return	pointer to the limbs, or NULL if the arena has not enough limbs left.
+ */
+static uint16_t* prvAlloc( size_t uxLimbs );
+
+/*
+ * Return the length of a magnitude without its most significant zero limbs.
+ */
+static size_t prvTrim( const uint16_t *pusA, size_t uxA );
+
+/*
+ * Compare two magnitudes.
+ * @return	-1 if A < B, 0 if A == B, 1 if A > B.
+ */
+static int prvMagCompare( const uint16_t *pusA, size_t uxA, const uint16_t *pusB, size_t uxB );
+
+/*
+ * R += B. R must have enough limbs to hold the result.
+ */
+static void prvMagAddTo( uint16_t *pusR, size_t uxR, const uint16_t *pusB, size_t uxB );
+
+/*
+ * R -= B. R must be greater or equal than B.
+ */
+static void prvMagSubFrom( uint16_t *pusR, size_t uxR, const uint16_t *pusB, size_t uxB );
+
+/*
+ * R = A * B with the schoolbook algorithm. R must have uxA + uxB limbs.
+ */
+static void prvMagMulSchool( uint16_t *pusR, const uint16_t *pusA, size_t uxA, const uint16_t *pusB, size_t uxB );
+
+/*
+ * R = A * B with Karatsuba algorithm, falling back to schoolbook on small operands.
+ * R must have uxA + uxB limbs. Temporal values are taken from the arena and released at end.
+ * @return	decimalOK or decimalERR_ARENA.
+ */
+static Decimal_Status_t prvMagMulKaratsuba( uint16_t *pusR, const uint16_t *pusA, size_t uxA, const uint16_t *pusB, size_t uxB );
+
+/*
+ * Q = U / V with long division (Knuth, algorithm D). The remainder is discarded.
+ * V must be trimmed and uxU >= uxV. Q must have uxU - uxV + 1 limbs.
+ * @return	decimalOK or decimalERR_ARENA.
+ */
+static Decimal_Status_t prvMagDiv( uint16_t *pusQ, const uint16_t *pusU, size_t uxU, const uint16_t *pusV, size_t uxV );
+
+/*
+ * Copy the magnitude of pxNumber on the arena with usScale limbs after the decimal point.
+ * usScale must be greater or equal than the scale of pxNumber.
+ * @return	pointer to the copy, or NULL if the arena has not enough limbs left.
+ */
+static uint16_t* prvAlign( const Decimal_t *pxNumber, uint16_t usScale, size_t *puxLength );
+
+/*
+ * Remove zero limbs at both ends of the number, and the sign of zero.
+ */
+static void prvNormalize( Decimal_t *pxNumber );
+
+/*
+ * pxResult = pxA + pxB, or pxA - pxB if bNegateB.
+ */
+static Decimal_Status_t prvAddSigned( Decimal_t *pxResult, const Decimal_t *pxA, const Decimal_t *pxB, bool bNegateB );
+
+
+/*=====[Private global variables definition]=====================================*/
+
+static uint16_t usArena[decimalARENA_LIMBS];		/**< Storage of all the limbs */
+static size_t uxArenaUsed = 0;						/**< Limbs of usArena taken */
+
+
+/*=====[Private functions implementation]===================================*/
+
+static uint16_t* prvAlloc( size_t uxLimbs )
+{
+	uint16_t *pusLimbs;
+
+	if( uxLimbs > decimalARENA_LIMBS - uxArenaUsed )
+		return NULL;
+
+	pusLimbs = &usArena[uxArenaUsed];
+	uxArenaUsed += uxLimbs;
+
+	return pusLimbs;
+}
+/*--------------------------------------------------------------------*/
+
+static size_t prvTrim( const uint16_t *pusA, size_t uxA )
+{
+	while( ( uxA > 0 ) && ( pusA[uxA - 1] == 0 ) )
+		uxA--;
+
+	return uxA;
+}
+/*--------------------------------------------------------------------*/
+
+static int prvMagCompare( const uint16_t *pusA, size_t uxA, const uint16_t *pusB, size_t uxB )
+{
+	uxA = prvTrim( pusA, uxA );
+	uxB = prvTrim( pusB, uxB );
+
+	if( uxA != uxB )
+		return ( uxA > uxB ) ? 1 : -1;
+
+	while( uxA-- > 0 )
+	{
+		if( pusA[uxA] != pusB[uxA] )
+			return ( pusA[uxA] > pusB[uxA] ) ? 1 : -1;
+	}
+
+	return 0;
+}
+/*--------------------------------------------------------------------*/
+
+static void prvMagAddTo( uint16_t *pusR, size_t uxR, const uint16_t *pusB, size_t uxB )
+{
+	uint32_t ulCarry = 0;
+	size_t loop;
+
+	uxB = prvTrim( pusB, uxB );
+
+	for( loop = 0 ; ( loop < uxR ) && ( ( loop < uxB ) || ( ulCarry != 0 ) ) ; loop++ )
+	{
+		ulCarry += pusR[loop];
+		if( loop < uxB )
+			ulCarry += pusB[loop];
+
+		pusR[loop] = ulCarry % decimalBASE;
+		ulCarry /= decimalBASE;
+	}
+}
+/*--------------------------------------------------------------------*/
+
+static void prvMagSubFrom( uint16_t *pusR, size_t uxR, const uint16_t *pusB, size_t uxB )
+{
+	int32_t lDigit, lBorrow = 0;
+	size_t loop;
+
+	uxB = prvTrim( pusB, uxB );
+
+	for( loop = 0 ; ( loop < uxR ) && ( ( loop < uxB ) || ( lBorrow != 0 ) ) ; loop++ )
+	{
+		lDigit = (int32_t)pusR[loop] - lBorrow;
+		if( loop < uxB )
+			lDigit -= pusB[loop];
+
+		lBorrow = 0;
+		if( lDigit < 0 )
+		{
+			lDigit += decimalBASE;
+			lBorrow = 1;
+		}
+		pusR[loop] = (uint16_t)lDigit;
+	}
+}
+/*--------------------------------------------------------------------*/
+
+static void prvMagMulSchool( uint16_t *pusR, const uint16_t *pusA, size_t uxA, const uint16_t *pusB, size_t uxB )
+{
+	uint32_t ulCarry;
+	size_t i, j;
+
+	memset( pusR, 0, ( uxA + uxB ) * sizeof( uint16_t ) );
+
+	for( i = 0 ; i < uxA ; i++ )
+	{
+		if( pusA[i] == 0 )
+			continue;
+
+		/* Each partial product is lower than 10000^2 + 2 * 10000, so it fit on 32 bits */
+		ulCarry = 0;
+		for( j = 0 ; j < uxB ; j++ )
+		{
+			ulCarry += pusR[i + j] + (uint32_t)pusA[i] * pusB[j];
+			pusR[i + j] = ulCarry % decimalBASE;
+			ulCarry /= decimalBASE;
+		}
+		pusR[i + uxB] = (uint16_t)ulCarry;
+	}
+}
+/*--------------------------------------------------------------------*/
+
+static Decimal_Status_t prvMagMulKaratsuba( uint16_t *pusR, const uint16_t *pusA, size_t uxA, const uint16_t *pusB, size_t uxB )
+{
+	const uint16_t *pusSwap;
+	size_t uxSwap, uxHalf, uxSumA, uxSumB, uxMiddle;
+	size_t uxMark = uxArenaUsed;
+	uint16_t *pusSumA, *pusSumB, *pusMiddle;
+	Decimal_Status_t xStatus;
+
+	/* A is always the longest */
+	if( uxA < uxB )
+	{
+		pusSwap = pusA; pusA = pusB; pusB = pusSwap;
+		uxSwap = uxA; uxA = uxB; uxB = uxSwap;
+	}
+
+	if( uxB < decimalKARATSUBA_THRESHOLD )
+	{
+		prvMagMulSchool( pusR, pusA, uxA, pusB, uxB );
+		return decimalOK;
+	}
+
+	uxHalf = uxA / 2;
+
+	if( uxB <= uxHalf )
+	{
+		/* Unbalanced operands: split only A. R = A0 * B + ( A1 * B ) << uxHalf */
+		uxMiddle = uxA - uxHalf + uxB;
+		pusMiddle = prvAlloc( uxMiddle );
+		if( pusMiddle == NULL )
+			return decimalERR_ARENA;
+
+		xStatus = prvMagMulKaratsuba( pusR, pusA, uxHalf, pusB, uxB );
+		if( xStatus == decimalOK )
+			xStatus = prvMagMulKaratsuba( pusMiddle, pusA + uxHalf, uxA - uxHalf, pusB, uxB );
+
+		if( xStatus == decimalOK )
+		{
+			memset( pusR + uxHalf + uxB, 0, ( uxA - uxHalf ) * sizeof( uint16_t ) );
+			prvMagAddTo( pusR + uxHalf, uxA + uxB - uxHalf, pusMiddle, uxMiddle );
+		}
+
+		uxArenaUsed = uxMark;
+		return xStatus;
+	}
+
+	/* Z0 = A0 * B0 on low limbs of R, and Z2 = A1 * B1 on high limbs of R */
+	xStatus = prvMagMulKaratsuba( pusR, pusA, uxHalf, pusB, uxHalf );
+	if( xStatus == decimalOK )
+		xStatus = prvMagMulKaratsuba( pusR + 2 * uxHalf, pusA + uxHalf, uxA - uxHalf, pusB + uxHalf, uxB - uxHalf );
+	if( xStatus != decimalOK )
+		return xStatus;
+
+	/* Z1 = ( A0 + A1 ) * ( B0 + B1 ) - Z0 - Z2 */
+	uxSumA = uxA - uxHalf + 1;
+	uxSumB = ( ( uxB - uxHalf > uxHalf ) ? uxB - uxHalf : uxHalf ) + 1;
+	pusSumA = prvAlloc( uxSumA );
+	pusSumB = prvAlloc( uxSumB );
+	pusMiddle = prvAlloc( uxSumA + uxSumB );
+	if( ( pusSumA == NULL ) || ( pusSumB == NULL ) || ( pusMiddle == NULL ) )
+	{
+		uxArenaUsed = uxMark;
+		return decimalERR_ARENA;
+	}
+
+	memset( pusSumA, 0, uxSumA * sizeof( uint16_t ) );
+	memcpy( pusSumA, pusA, uxHalf * sizeof( uint16_t ) );
+	prvMagAddTo( pusSumA, uxSumA, pusA + uxHalf, uxA - uxHalf );
+
+	memset( pusSumB, 0, uxSumB * sizeof( uint16_t ) );
+	memcpy( pusSumB, pusB, uxHalf * sizeof( uint16_t ) );
+	prvMagAddTo( pusSumB, uxSumB, pusB + uxHalf, uxB - uxHalf );
+
+	uxSumA = prvTrim( pusSumA, uxSumA );
+	uxSumB = prvTrim( pusSumB, uxSumB );
+	uxMiddle = uxSumA + uxSumB;
+
+	xStatus = prvMagMulKaratsuba( pusMiddle, pusSumA, uxSumA, pusSumB, uxSumB );
+	if( xStatus == decimalOK )
+	{
+		prvMagSubFrom( pusMiddle, uxMiddle, pusR, 2 * uxHalf );
+		prvMagSubFrom( pusMiddle, uxMiddle, pusR + 2 * uxHalf, uxA + uxB - 2 * uxHalf );
+
+		/* Z1 = A0 * B1 + A1 * B0, so once trimmed it always fit on R */
+		prvMagAddTo( pusR + uxHalf, uxA + uxB - uxHalf, pusMiddle, prvTrim( pusMiddle, uxMiddle ) );
+	}
+
+	uxArenaUsed = uxMark;
+	return xStatus;
+}
+/*--------------------------------------------------------------------*/
+
+static Decimal_Status_t prvMagDiv( uint16_t *pusQ, const uint16_t *pusU, size_t uxU, const uint16_t *pusV, size_t uxV )
+{
+	size_t uxMark = uxArenaUsed;
+	uint16_t *pusUn, *pusVn;
+	uint32_t ulNormalize, ulCarry, ulNumerator, ulQHat, ulRHat, ulProduct;
+	int32_t lDigit, lBorrow;
+	size_t i, j;
+
+	/* One limb divisor: short division */
+	if( uxV == 1 )
+	{
+		ulCarry = 0;
+		for( i = uxU ; i-- > 0 ; )
+		{
+			ulNumerator = ulCarry * decimalBASE + pusU[i];
+			pusQ[i] = (uint16_t)( ulNumerator / pusV[0] );
+			ulCarry = ulNumerator % pusV[0];
+		}
+		return decimalOK;
+	}
+
+	pusUn = prvAlloc( uxU + 1 );
+	pusVn = prvAlloc( uxV );
+	if( ( pusUn == NULL ) || ( pusVn == NULL ) )
+	{
+		uxArenaUsed = uxMark;
+		return decimalERR_ARENA;
+	}
+
+	/* Normalize so the most significant limb of V is at least decimalBASE / 2,
+	then each estimated quotient limb is at most 2 units larger than the real one */
+	ulNormalize = decimalBASE / ( pusV[uxV - 1] + 1 );
+
+	for( i = 0, ulCarry = 0 ; i < uxU ; i++ )
+	{
+		ulCarry += pusU[i] * ulNormalize;
+		pusUn[i] = ulCarry % decimalBASE;
+		ulCarry /= decimalBASE;
+	}
+	pusUn[uxU] = (uint16_t)ulCarry;
+
+	for( i = 0, ulCarry = 0 ; i < uxV ; i++ )
+	{
+		ulCarry += pusV[i] * ulNormalize;
+		pusVn[i] = ulCarry % decimalBASE;
+		ulCarry /= decimalBASE;
+	}
+
+	for( j = uxU - uxV + 1 ; j-- > 0 ; )
+	{
+		/* Estimate quotient limb from the two most significant limbs */
+		ulNumerator = pusUn[j + uxV] * (uint32_t)decimalBASE + pusUn[j + uxV - 1];
+		ulQHat = ulNumerator / pusVn[uxV - 1];
+		ulRHat = ulNumerator % pusVn[uxV - 1];
+
+		while( ( ulQHat >= decimalBASE ) || ( ulQHat * pusVn[uxV - 2] > ulRHat * decimalBASE + pusUn[j + uxV - 2] ) )
+		{
+			ulQHat--;
+			ulRHat += pusVn[uxV - 1];
+			if( ulRHat >= decimalBASE )
+				break;
+		}
+
+		/* Multiply and subtract */
+		ulCarry = 0;
+		lBorrow = 0;
+		for( i = 0 ; i < uxV ; i++ )
+		{
+			ulProduct = ulQHat * pusVn[i] + ulCarry;
+			ulCarry = ulProduct / decimalBASE;
+			lDigit = (int32_t)pusUn[i + j] - (int32_t)( ulProduct % decimalBASE ) - lBorrow;
+			lBorrow = 0;
+			if( lDigit < 0 )
+			{
+				lDigit += decimalBASE;
+				lBorrow = 1;
+			}
+			pusUn[i + j] = (uint16_t)lDigit;
+		}
+		lDigit = (int32_t)pusUn[j + uxV] - (int32_t)ulCarry - lBorrow;
+
+		if( lDigit < 0 )
+		{
+			/* Estimation was one too large: add back */
+			ulQHat--;
+			ulCarry = 0;
+			for( i = 0 ; i < uxV ; i++ )
+			{
+				ulCarry += (uint32_t)pusUn[i + j] + pusVn[i];
+				pusUn[i + j] = ulCarry % decimalBASE;
+				ulCarry /= decimalBASE;
+			}
+			lDigit += (int32_t)ulCarry;
+		}
+		pusUn[j + uxV] = (uint16_t)lDigit;
+
+		pusQ[j] = (uint16_t)ulQHat;
+	}
+
+	uxArenaUsed = uxMark;
+	return decimalOK;
+}
+/*--------------------------------------------------------------------*/
+
+static uint16_t* prvAlign( const Decimal_t *pxNumber, uint16_t usScale, size_t *puxLength )
+{
+	size_t uxShift = usScale - pxNumber->usScale;
+	uint16_t *pusLimbs;
+
+	*puxLength = pxNumber->usLength + uxShift;
+	pusLimbs = prvAlloc( *puxLength );
+
+	if( pusLimbs != NULL )
+	{
+		memset( pusLimbs, 0, uxShift * sizeof( uint16_t ) );
+		memcpy( pusLimbs + uxShift, pxNumber->pusLimbs, pxNumber->usLength * sizeof( uint16_t ) );
+	}
+
+	return pusLimbs;
+}
+/*--------------------------------------------------------------------*/
+
+static void prvNormalize( Decimal_t *pxNumber )
+{
+	pxNumber->usLength = (uint16_t)prvTrim( pxNumber->pusLimbs, pxNumber->usLength );
+
+	/* Zero limbs after the decimal point are not needed */
+	while( ( pxNumber->usScale > 0 ) && ( pxNumber->usLength > 0 ) && ( pxNumber->pusLimbs[0] == 0 ) )
+	{
+		pxNumber->pusLimbs++;
+		pxNumber->usLength--;
+		pxNumber->usScale--;
+	}
+
+	if( pxNumber->usLength == 0 )
+	{
+		pxNumber->usScale = 0;
+		pxNumber->bNegative = false;
+	}
+}
+/*--------------------------------------------------------------------*/
+
+static Decimal_Status_t prvAddSigned( Decimal_t *pxResult, const Decimal_t *pxA, const Decimal_t *pxB, bool bNegateB )
+{
+	uint16_t usScale = ( pxA->usScale > pxB->usScale ) ? pxA->usScale : pxB->usScale;
+	bool bNegativeB = pxB->bNegative ^ bNegateB;
+	uint16_t *pusA, *pusB, *pusR;
+	size_t uxA, uxB, uxR;
+
+	/* Put both numbers with the same amount of limbs after decimal point */
+	pusA = prvAlign( pxA, usScale, &uxA );
+	pusB = prvAlign( pxB, usScale, &uxB );
+	uxR = ( ( uxA > uxB ) ? uxA : uxB ) + 1;
+	pusR = prvAlloc( uxR );
+	if( ( pusA == NULL ) || ( pusB == NULL ) || ( pusR == NULL ) )
+		return decimalERR_ARENA;
+
+	memset( pusR, 0, uxR * sizeof( uint16_t ) );
+
+	if( pxA->bNegative == bNegativeB )
+	{
+		/* Same sign: add magnitudes */
+		memcpy( pusR, pusA, uxA * sizeof( uint16_t ) );
+		prvMagAddTo( pusR, uxR, pusB, uxB );
+		pxResult->bNegative = pxA->bNegative;
+	}
+	else if( prvMagCompare( pusA, uxA, pusB, uxB ) >= 0 )
+	{
+		/* Different sign: subtract the smallest magnitude from the largest */
+		memcpy( pusR, pusA, uxA * sizeof( uint16_t ) );
+		prvMagSubFrom( pusR, uxR, pusB, uxB );
+		pxResult->bNegative = pxA->bNegative;
+	}
+	else
+	{
+		memcpy( pusR, pusB, uxB * sizeof( uint16_t ) );
+		prvMagSubFrom( pusR, uxR, pusA, uxA );
+		pxResult->bNegative = bNegativeB;
+	}
+
+	pxResult->pusLimbs = pusR;
+	pxResult->usLength = (uint16_t)uxR;
+	pxResult->usScale = usScale;
+	prvNormalize( pxResult );
+
+	return decimalOK;
+}
+
+
+/*=====[Public functions implementation]===================================*/
+
+void Decimal_Reset( void )
+{
+	uxArenaUsed = 0;
+}
+/*-----------------------------------------------------------*/
+
+Decimal_Status_t Decimal_Parse( Decimal_t *pxNumber, const char *pcString, size_t uxLength )
+{
+	static const uint16_t usPower[decimalBASE_DIGITS] = { 1, 10, 100, 1000 };
+	size_t uxIntDigits = 0, uxFracDigits = 0, uxDigit, loop;
+	bool bPoint = false, bNegative = false;
+	uint16_t *pusLimbs;
+	uint16_t usScale;
+	size_t uxLimbs;
+
+	if( ( uxLength > 0 ) && ( *pcString == '-' ) )
+	{
+		bNegative = true;
+		pcString++;
+		uxLength--;
+	}
+
+	/* Count digits before and after the decimal point */
+	for( loop = 0 ; loop < uxLength ; loop++ )
+	{
+		if( ( pcString[loop] == '.' ) && !bPoint )
+			bPoint = true;
+		else if( ( pcString[loop] < '0' ) || ( pcString[loop] > '9' ) )
+			return decimalERR_SYNTAX;
+		else if( bPoint )
+			uxFracDigits++;
+		else
+			uxIntDigits++;
+	}
+
+	if( uxIntDigits + uxFracDigits == 0 )
+		return decimalERR_SYNTAX;
+
+	usScale = (uint16_t)( ( uxFracDigits + decimalBASE_DIGITS - 1 ) / decimalBASE_DIGITS );
+	uxLimbs = usScale + ( uxIntDigits + decimalBASE_DIGITS - 1 ) / decimalBASE_DIGITS;
+	pusLimbs = prvAlloc( uxLimbs );
+	if( pusLimbs == NULL )
+		return decimalERR_ARENA;
+
+	memset( pusLimbs, 0, uxLimbs * sizeof( uint16_t ) );
+
+	/* Integer digits, from the units */
+	for( uxDigit = 0 ; uxDigit < uxIntDigits ; uxDigit++ )
+		pusLimbs[usScale + uxDigit / decimalBASE_DIGITS] += ( pcString[uxIntDigits - 1 - uxDigit] - '0' ) * usPower[uxDigit % decimalBASE_DIGITS];
+
+	/* Fraction digits, from the decimal point */
+	for( uxDigit = 0 ; uxDigit < uxFracDigits ; uxDigit++ )
+		pusLimbs[usScale - 1 - uxDigit / decimalBASE_DIGITS] += ( pcString[uxIntDigits + 1 + uxDigit] - '0' ) * usPower[decimalBASE_DIGITS - 1 - uxDigit % decimalBASE_DIGITS];
+
+	pxNumber->pusLimbs = pusLimbs;
+	pxNumber->usLength = (uint16_t)uxLimbs;
+	pxNumber->usScale = usScale;
+	pxNumber->bNegative = bNegative;
+	prvNormalize( pxNumber );
+
+	return decimalOK;
+}
+/*-----------------------------------------------------------*/
+
+Decimal_Status_t Decimal_Add( Decimal_t *pxResult, const Decimal_t *pxA, const Decimal_t *pxB )
+{
+	return prvAddSigned( pxResult, pxA, pxB, false );
+}
+/*-----------------------------------------------------------*/
+
+Decimal_Status_t Decimal_Sub( Decimal_t *pxResult, const Decimal_t *pxA, const Decimal_t *pxB )
+{
+	return prvAddSigned( pxResult, pxA, pxB, true );
+}
+/*-----------------------------------------------------------*/
+
+Decimal_Status_t Decimal_Mul( Decimal_t *pxResult, const Decimal_t *pxA, const Decimal_t *pxB )
+{
+	size_t uxR = pxA->usLength + pxB->usLength;
+	uint16_t *pusR = prvAlloc( uxR );
+	Decimal_Status_t xStatus;
+
+	if( pusR == NULL )
+		return decimalERR_ARENA;
+
+	xStatus = prvMagMulKaratsuba( pusR, pxA->pusLimbs, pxA->usLength, pxB->pusLimbs, pxB->usLength );
+	if( xStatus != decimalOK )
+		return xStatus;
+
+	pxResult->pusLimbs = pusR;
+	pxResult->usLength = (uint16_t)uxR;
+	pxResult->usScale = pxA->usScale + pxB->usScale;
+	pxResult->bNegative = pxA->bNegative ^ pxB->bNegative;
+	prvNormalize( pxResult );
+
+	return decimalOK;
+}
+/*-----------------------------------------------------------*/
+
+Decimal_Status_t Decimal_Div( Decimal_t *pxResult, const Decimal_t *pxA, const Decimal_t *pxB )
+{
+	int xShift = decimalDIV_LIMBS + pxB->usScale - pxA->usScale;
+	Decimal_t xNumerator = *pxA, xDenominator = *pxB;
+	uint16_t *pusU, *pusV, *pusQ;
+	size_t uxU, uxV, uxQ;
+
+	if( prvTrim( pxB->pusLimbs, pxB->usLength ) == 0 )
+		return decimalERR_DIV_ZERO;
+
+	/* A / B * 10000^decimalDIV_LIMBS = ( a / b ) * 10000^xShift, with a and b the limbs as integers.
+	Shift the numerator or the denominator so the quotient of integers give the result */
+	xNumerator.usScale = 0;
+	xDenominator.usScale = 0;
+	if( xShift >= 0 )
+	{
+		pusU = prvAlign( &xNumerator, (uint16_t)xShift, &uxU );
+		pusV = prvAlign( &xDenominator, 0, &uxV );
+	}
+	else
+	{
+		pusU = prvAlign( &xNumerator, 0, &uxU );
+		pusV = prvAlign( &xDenominator, (uint16_t)( -xShift ), &uxV );
+	}
+	if( ( pusU == NULL ) || ( pusV == NULL ) )
+		return decimalERR_ARENA;
+
+	uxU = prvTrim( pusU, uxU );
+	uxV = prvTrim( pusV, uxV );
+
+	pxResult->usScale = decimalDIV_LIMBS;
+	pxResult->bNegative = pxA->bNegative ^ pxB->bNegative;
+
+	if( uxU < uxV )
+	{
+		/* Result is lower than the last limb after the decimal point */
+		pxResult->pusLimbs = pusU;
+		pxResult->usLength = 0;
+		prvNormalize( pxResult );
+		return decimalOK;
+	}
+
+	uxQ = uxU - uxV + 1;
+	pusQ = prvAlloc( uxQ );
+	if( pusQ == NULL )
+		return decimalERR_ARENA;
+
+	if( prvMagDiv( pusQ, pusU, uxU, pusV, uxV ) != decimalOK )
+		return decimalERR_ARENA;
+
+	pxResult->pusLimbs = pusQ;
+	pxResult->usLength = (uint16_t)uxQ;
+	prvNormalize( pxResult );
+
+	return decimalOK;
+}
+/*-----------------------------------------------------------*/
+
+Decimal_Status_t Decimal_Format( const Decimal_t *pxNumber, char *pcBuffer, size_t xBufferLen )
+{
+	size_t uxPos = 0, uxLimb, uxFirstNonZero, uxIntegerDigits = 1;
+	uint16_t usLimb;
+	int xDigit;
+	bool bLeading = true;
+
+	/* Integer digits printed: those of the highest non zero integer limb, 4 per
+	limb below it, or a single "0" */
+	for( uxLimb = pxNumber->usLength ; uxLimb-- > pxNumber->usScale ; )
+	{
+		if( pxNumber->pusLimbs[uxLimb] != 0 )
+		{
+			for( xDigit = 10 ; ( xDigit <= 1000 ) && ( pxNumber->pusLimbs[uxLimb] >= xDigit ) ; xDigit *= 10 )
+				uxIntegerDigits++;
+			uxIntegerDigits += ( uxLimb - pxNumber->usScale ) * decimalBASE_DIGITS;
+			break;
+		}
+	}
+
+	/* Sign, integer digits, point, 4 digits per fraction limb and null terminator */
+	if( xBufferLen < 1 + uxIntegerDigits + 1 + (size_t)pxNumber->usScale * decimalBASE_DIGITS + 1 )
+		return decimalERR_BUFFER;
+
+	if( pxNumber->bNegative )
+		pcBuffer[uxPos++] = '-';
+
+	/* Integer part, without leading zeros */
+	for( uxLimb = pxNumber->usLength ; uxLimb-- > pxNumber->usScale ; )
+	{
+		usLimb = pxNumber->pusLimbs[uxLimb];
+		for( xDigit = 1000 ; xDigit > 0 ; xDigit /= 10 )
+		{
+			if( bLeading && ( usLimb / xDigit == 0 ) )
+				continue;
+			bLeading = false;
+			pcBuffer[uxPos++] = '0' + ( usLimb / xDigit ) % 10;
+		}
+	}
+	if( bLeading )
+		pcBuffer[uxPos++] = '0';
+
+	/* Fraction part, without trailing zeros */
+	if( pxNumber->usScale > 0 )
+	{
+		pcBuffer[uxPos++] = '.';
+		uxFirstNonZero = uxPos;
+		for( uxLimb = pxNumber->usScale ; uxLimb-- > 0 ; )
+		{
+			usLimb = ( uxLimb < pxNumber->usLength ) ? pxNumber->pusLimbs[uxLimb] : 0;
+			for( xDigit = 1000 ; xDigit > 0 ; xDigit /= 10 )
+			{
+				pcBuffer[uxPos++] = '0' + ( usLimb / xDigit ) % 10;
+				if( pcBuffer[uxPos - 1] != '0' )
+					uxFirstNonZero = uxPos;
+			}
+		}
+		uxPos = uxFirstNonZero;
+		if( pcBuffer[uxPos - 1] == '.' )
+			uxPos--;
+	}
+
+	pcBuffer[uxPos] = '\0';
+
+	return decimalOK;
+}
@@ -0,0 +1,482 @@
+/*
+ * fastmath.c
+ *
+ *  Elementary functions in single precision with table, CORDIC and polynomial kernels.
+ */
+
+/*=====[Includes]===========================================================*/
+
+#include <math.h>
+#include <float.h>
+#include <stdbool.h>
+#include "fastmath.h"
+
+
+/*=====[Definitions and macros]=============================================*/
+
+#define fastmathPI					3.14159265f
+#define fastmathINV_2PI				0.159154943f
+#define fastmath2_PI				0.636619772f
+#define fastmathSQRT2				1.41421356f
+#define fastmathLOG2E				1.44269504f
+
+/* Constants split in a high part with few bits, so k * HI is exact, and the
+rest (Cody-Waite range reduction) */
+#define fastmath2PI_HI				6.28125f
+#define fastmath2PI_LO				1.93530717e-3f
+#define fastmathPIO2_1				1.5703125f
+#define fastmathPIO2_2				4.83751297e-4f
+#define fastmathPIO2_3				7.54978995e-8f
+#define fastmathLN2_HI				0.693359375f
+#define fastmathLN2_LO				-2.12194440e-4f
+
+/* Phase steps on a whole turn of the sine table */
+#define fastmathSIN_TURN			( 4 * fastmathSIN_TABLE_SIZE )
+
+
+/*=====[Private global variables definition]=====================================*/
+
+/**
+ *  sin( i * pi / 2 / fastmathSIN_TABLE_SIZE ), a quarter of turn and one point more to interpolate.
+ */
+static const float fSinTable[fastmathSIN_TABLE_SIZE + 1] =
+{
+	0.0f, 6.135884649e-03f, 1.227153829e-02f, 1.840672991e-02f, 2.454122852e-02f, 3.067480318e-02f,
+	3.680722294e-02f, 4.293825693e-02f, 4.906767433e-02f, 5.519524435e-02f, 6.132073630e-02f, 6.744391956e-02f,
+	7.356456360e-02f, 7.968243797e-02f, 8.579731234e-02f, 9.190895650e-02f, 9.801714033e-02f, 1.041216339e-01f,
+	1.102222073e-01f, 1.163186309e-01f, 1.224106752e-01f, 1.284981108e-01f, 1.345807085e-01f, 1.406582393e-01f,
+	1.467304745e-01f, 1.527971853e-01f, 1.588581433e-01f, 1.649131205e-01f, 1.709618888e-01f, 1.770042204e-01f,
+	1.830398880e-01f, 1.890686641e-01f, 1.950903220e-01f, 2.011046348e-01f, 2.071113762e-01f, 2.131103199e-01f,
+	2.191012402e-01f, 2.250839114e-01f, 2.310581083e-01f, 2.370236060e-01f, 2.429801799e-01f, 2.489276057e-01f,
+	2.548656596e-01f, 2.607941179e-01f, 2.667127575e-01f, 2.726213554e-01f, 2.785196894e-01f, 2.844075372e-01f,
+	2.902846773e-01f, 2.961508882e-01f, 3.020059493e-01f, 3.078496400e-01f, 3.136817404e-01f, 3.195020308e-01f,
+	3.253102922e-01f, 3.311063058e-01f, 3.368898534e-01f, 3.426607173e-01f, 3.484186802e-01f, 3.541635254e-01f,
+	3.598950365e-01f, 3.656129978e-01f, 3.713171940e-01f, 3.770074102e-01f, 3.826834324e-01f, 3.883450467e-01f,
+	3.939920401e-01f, 3.996241998e-01f, 4.052413140e-01f, 4.108431711e-01f, 4.164295601e-01f, 4.220002708e-01f,
+	4.275550934e-01f, 4.330938189e-01f, 4.386162385e-01f, 4.441221446e-01f, 4.496113297e-01f, 4.550835871e-01f,
+	4.605387110e-01f, 4.659764958e-01f, 4.713967368e-01f, 4.767992301e-01f, 4.821837721e-01f, 4.875501601e-01f,
+	4.928981922e-01f, 4.982276670e-01f, 5.035383837e-01f, 5.088301425e-01f, 5.141027442e-01f, 5.193559902e-01f,
+	5.245896827e-01f, 5.298036247e-01f, 5.349976199e-01f, 5.401714727e-01f, 5.453249884e-01f, 5.504579729e-01f,
+	5.555702330e-01f, 5.606615762e-01f, 5.657318108e-01f, 5.707807459e-01f, 5.758081914e-01f, 5.808139581e-01f,
+	5.857978575e-01f, 5.907597019e-01f, 5.956993045e-01f, 6.006164794e-01f, 6.055110414e-01f, 6.103828063e-01f,
+	6.152315906e-01f, 6.200572118e-01f, 6.248594881e-01f, 6.296382389e-01f, 6.343932842e-01f, 6.391244449e-01f,
+	6.438315429e-01f, 6.485144010e-01f, 6.531728430e-01f, 6.578066933e-01f, 6.624157776e-01f, 6.669999223e-01f,
+	6.715589548e-01f, 6.760927036e-01f, 6.806009978e-01f, 6.850836678e-01f, 6.895405447e-01f, 6.939714609e-01f,
+	6.983762494e-01f, 7.027547445e-01f, 7.071067812e-01f, 7.114321957e-01f, 7.157308253e-01f, 7.200025080e-01f,
+	7.242470830e-01f, 7.284643904e-01f, 7.326542717e-01f, 7.368165689e-01f, 7.409511254e-01f, 7.450577854e-01f,
+	7.491363945e-01f, 7.531867990e-01f, 7.572088465e-01f, 7.612023855e-01f, 7.651672656e-01f, 7.691033376e-01f,
+	7.730104534e-01f, 7.768884657e-01f, 7.807372286e-01f, 7.845565972e-01f, 7.883464276e-01f, 7.921065773e-01f,
+	7.958369046e-01f, 7.995372691e-01f, 8.032075315e-01f, 8.068475535e-01f, 8.104571983e-01f, 8.140363297e-01f,
+	8.175848132e-01f, 8.211025150e-01f, 8.245893028e-01f, 8.280450453e-01f, 8.314696123e-01f, 8.348628750e-01f,
+	8.382247056e-01f, 8.415549774e-01f, 8.448535652e-01f, 8.481203448e-01f, 8.513551931e-01f, 8.545579884e-01f,
+	8.577286100e-01f, 8.608669386e-01f, 8.639728561e-01f, 8.670462455e-01f, 8.700869911e-01f, 8.730949784e-01f,
+	8.760700942e-01f, 8.790122264e-01f, 8.819212643e-01f, 8.847970984e-01f, 8.876396204e-01f, 8.904487232e-01f,
+	8.932243012e-01f, 8.959662498e-01f, 8.986744657e-01f, 9.013488470e-01f, 9.039892931e-01f, 9.065957045e-01f,
+	9.091679831e-01f, 9.117060320e-01f, 9.142097557e-01f, 9.166790599e-01f, 9.191138517e-01f, 9.215140393e-01f,
+	9.238795325e-01f, 9.262102421e-01f, 9.285060805e-01f, 9.307669611e-01f, 9.329927988e-01f, 9.351835099e-01f,
+	9.373390119e-01f, 9.394592236e-01f, 9.415440652e-01f, 9.435934582e-01f, 9.456073254e-01f, 9.475855910e-01f,
+	9.495281806e-01f, 9.514350210e-01f, 9.533060404e-01f, 9.551411683e-01f, 9.569403357e-01f, 9.587034749e-01f,
+	9.604305194e-01f, 9.621214043e-01f, 9.637760658e-01f, 9.653944417e-01f, 9.669764710e-01f, 9.685220943e-01f,
+	9.700312532e-01f, 9.715038910e-01f, 9.729399522e-01f, 9.743393828e-01f, 9.757021300e-01f, 9.770281427e-01f,
+	9.783173707e-01f, 9.795697657e-01f, 9.807852804e-01f, 9.819638691e-01f, 9.831054874e-01f, 9.842100924e-01f,
+	9.852776424e-01f, 9.863080972e-01f, 9.873014182e-01f, 9.882575677e-01f, 9.891765100e-01f, 9.900582103e-01f,
+	9.909026354e-01f, 9.917097537e-01f, 9.924795346e-01f, 9.932119492e-01f, 9.939069700e-01f, 9.945645707e-01f,
+	9.951847267e-01f, 9.957674145e-01f, 9.963126122e-01f, 9.968202993e-01f, 9.972904567e-01f, 9.977230666e-01f,
+	9.981181129e-01f, 9.984755806e-01f, 9.987954562e-01f, 9.990777278e-01f, 9.993223846e-01f, 9.995294175e-01f,
+	9.996988187e-01f, 9.998305818e-01f, 9.999247018e-01f, 9.999811753e-01f, 1.0f
+};
+
+/**
+ *  atan( 2^-i ), angle rotated on each CORDIC iteration.
+ */
+static const float fCordicAngles[fastmathCORDIC_PRECISE_ITERATIONS] =
+{
+	7.853981634e-01f, 4.636476090e-01f, 2.449786631e-01f, 1.243549945e-01f,
+	6.241881000e-02f, 3.123983343e-02f, 1.562372862e-02f, 7.812341060e-03f,
+	3.906230132e-03f, 1.953122516e-03f, 9.765621896e-04f, 4.882812112e-04f,
+	2.441406201e-04f, 1.220703119e-04f, 6.103515617e-05f, 3.051757812e-05f
+};
+
+
+/*=====[Private functions implementation]===================================*/
+
+static inline uint32_t prvToBits( float fX )
+{
+	union { float f; uint32_t ul; } xValue = { .f = fX };
+
+	return xValue.ul;
+}
+/*-----------------------------------------------------------*/
+
+static inline float prvFromBits( uint32_t ulBits )
+{
+	union { float f; uint32_t ul; } xValue = { .ul = ulBits };
+
+	return xValue.f;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Round to the nearest integer. Values above 2^23 are already integers.
+ */
+static inline float prvRound( float fX )
+{
+	if( fabsf( fX ) >= 8388608.0f )
+		return fX;
+
+	return (float)(int32_t)( fX + ( ( fX < 0.0f ) ? -0.5f : 0.5f ) );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * 2^lExponent, for lExponent on [-126, 127].
+ */
+static inline float prvPow2( int32_t lExponent )
+{
+	return prvFromBits( (uint32_t)( lExponent + 127 ) << 23 );
+}
+/*-----------------------------------------------------------*/
+
+static inline float prvSqrt( float fX, bool bPrecise )
+{
+	float fY, fS, fHalf;
+	float fScale = 1.0f;
+
+	/* Zero, negative, NaN and infinite */
+	if( !( fX > 0.0f ) )
+		return ( fX == 0.0f ) ? fX : NAN;
+	if( fX > FLT_MAX )
+		return fX;
+
+	/* Subnormal: the estimate needs a normal exponent */
+	if( fX < FLT_MIN )
+	{
+		fX *= 16777216.0f;		/* 2^24 */
+		fScale = 1.0f / 4096.0f;
+	}
+
+	/* Inverse square root: estimate from the exponent, refined with Newton */
+	fY = prvFromBits( 0x5f3759dfUL - ( prvToBits( fX ) >> 1 ) );
+	fHalf = 0.5f * fX;
+	fY = fY * ( 1.5f - fHalf * fY * fY );
+	if( bPrecise )
+		fY = fY * ( 1.5f - fHalf * fY * fY );
+
+	fS = fX * fY;
+	if( bPrecise )
+		fS = fS + 0.5f * fY * ( fX - fS * fS );
+
+	return fS * fScale;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Sine from the table. ulOffset is added to the phase, a quarter of turn gives cosine.
+ */
+static inline float prvSinTable( float fX, uint32_t ulOffset )
+{
+	float fK, fPhase, fFrac, fA, fB;
+	uint32_t ulIndex, ulStep;
+
+	if( !( fabsf( fX ) <= FLT_MAX ) )
+		return NAN;
+
+	/* r = x - k * 2pi on [-pi, pi], then phase on table steps on [0, fastmathSIN_TURN] */
+	fK = prvRound( fX * fastmathINV_2PI );
+	fPhase = ( ( fX - fK * fastmath2PI_HI ) - fK * fastmath2PI_LO ) * ( fastmathSIN_TURN * fastmathINV_2PI );
+	if( fPhase < 0.0f )
+		fPhase += fastmathSIN_TURN;
+
+	ulIndex = (uint32_t)fPhase;
+	fFrac = fPhase - (float)ulIndex;
+	ulIndex = ( ulIndex + ulOffset ) & ( fastmathSIN_TURN - 1 );
+	ulStep = ulIndex & ( fastmathSIN_TABLE_SIZE - 1 );
+
+	/* Odd quarters run the table backwards, the second half is negative */
+	if( ulIndex & fastmathSIN_TABLE_SIZE )
+	{
+		fA = fSinTable[fastmathSIN_TABLE_SIZE - ulStep];
+		fB = fSinTable[fastmathSIN_TABLE_SIZE - ulStep - 1];
+	}
+	else
+	{
+		fA = fSinTable[ulStep];
+		fB = fSinTable[ulStep + 1];
+	}
+	if( ulIndex & ( 2 * fastmathSIN_TABLE_SIZE ) )
+	{
+		fA = -fA;
+		fB = -fB;
+	}
+
+	return fA + fFrac * ( fB - fA );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Sine with minimax polynomials. ulOffset is added to the quarter, 1 gives cosine.
+ */
+static inline float prvSinPoly( float fX, uint32_t ulOffset )
+{
+	float fK, fR, fZ, fY;
+	uint32_t ulQuarter;
+
+	if( !( fabsf( fX ) <= FLT_MAX ) )
+		return NAN;
+
+	/* r = x - k * pi/2 on [-pi/4, pi/4] */
+	fK = prvRound( fX * fastmath2_PI );
+	fR = ( ( fX - fK * fastmathPIO2_1 ) - fK * fastmathPIO2_2 ) - fK * fastmathPIO2_3;
+	ulQuarter = ( (uint32_t)(int32_t)fK + ulOffset ) & 3;
+	fZ = fR * fR;
+
+	if( ulQuarter & 1 )
+		fY = ( ( 2.443315711809948e-5f * fZ - 1.388731625493765e-3f ) * fZ + 4.166664568298827e-2f ) * fZ * fZ - 0.5f * fZ + 1.0f;
+	else
+		fY = ( ( -1.9515295891e-4f * fZ + 8.3321608736e-3f ) * fZ - 1.6666654611e-1f ) * fZ * fR + fR;
+
+	return ( ulQuarter & 2 ) ? -fY : fY;
+}
+/*-----------------------------------------------------------*/
+
+static inline float prvAtan2( float fY, float fX, bool bPrecise )
+{
+	float fAngle = 0.0f;
+	float fPow = 1.0f;
+	float fXn;
+	int loop, xIterations;
+
+	if( ( fX != fX ) || ( fY != fY ) )
+		return NAN;
+	if( ( fX == 0.0f ) && ( fY == 0.0f ) )
+		return 0.0f;
+
+	/* Only the direction matters: infinite to unit, and far from overflow and subnormals */
+	if( ( fabsf( fX ) > FLT_MAX ) || ( fabsf( fY ) > FLT_MAX ) )
+	{
+		fX = ( fabsf( fX ) > FLT_MAX ) ? copysignf( 1.0f, fX ) : 0.0f;
+		fY = ( fabsf( fY ) > FLT_MAX ) ? copysignf( 1.0f, fY ) : 0.0f;
+	}
+	else if( ( fabsf( fX ) > 1e30f ) || ( fabsf( fY ) > 1e30f ) )
+	{
+		fX *= 5.42101086e-20f;		/* 2^-64 */
+		fY *= 5.42101086e-20f;
+	}
+	else if( ( fabsf( fX ) < 1e-30f ) && ( fabsf( fY ) < 1e-30f ) )
+	{
+		fX *= 1.84467441e19f;		/* 2^64 */
+		fY *= 1.84467441e19f;
+	}
+
+	/* Left half plane: rotate half turn */
+	if( fX < 0.0f )
+	{
+		fAngle = ( fY < 0.0f ) ? -fastmathPI : fastmathPI;
+		fX = -fX;
+		fY = -fY;
+	}
+
+	/* Rotate towards the x axis by atan( 2^-i ), accumulating the angle rotated */
+	xIterations = bPrecise ? fastmathCORDIC_PRECISE_ITERATIONS : fastmathCORDIC_FAST_ITERATIONS;
+	for( loop = 0 ; loop < xIterations ; loop++ )
+	{
+		fXn = fX;
+		if( fY > 0.0f )
+		{
+			fX += fY * fPow;
+			fY -= fXn * fPow;
+			fAngle += fCordicAngles[loop];
+		}
+		else
+		{
+			fX -= fY * fPow;
+			fY += fXn * fPow;
+			fAngle -= fCordicAngles[loop];
+		}
+		fPow *= 0.5f;
+	}
+
+	/* The angle left is small enough to be y / x */
+	if( bPrecise )
+		fAngle += fY / fX;
+
+	return fAngle;
+}
+/*-----------------------------------------------------------*/
+
+static inline float prvExp( float fX, bool bPrecise )
+{
+	float fK, fR, fP;
+	int32_t lK;
+
+	if( fX != fX )
+		return NAN;
+	if( fX > fastmathEXP_MAX_ARGUMENT )
+		return INFINITY;
+	if( fX < fastmathEXP_MIN_ARGUMENT )
+		return 0.0f;
+
+	/* exp( x ) = exp( r ) * 2^k */
+	fK = prvRound( fX * fastmathLOG2E );
+	fR = ( fX - fK * fastmathLN2_HI ) - fK * fastmathLN2_LO;
+	lK = (int32_t)fK;
+
+	if( bPrecise )
+		fP = ( ( ( ( ( 1.9875691500e-4f * fR + 1.3981999507e-3f ) * fR + 8.3334519073e-3f ) * fR
+				+ 4.1665795894e-2f ) * fR + 1.6666665459e-1f ) * fR + 5.0000001201e-1f ) * fR * fR + fR + 1.0f;
+	else
+		fP = ( ( 1.67670119e-1f * fR + 5.05022284e-1f ) * fR + 9.99984929e-1f ) * fR + 9.99924557e-1f;
+
+	/* 2^128 does not fit on the exponent */
+	if( lK > 127 )
+		return fP * 2.0f * prvPow2( lK - 1 );
+
+	return fP * prvPow2( lK );
+}
+/*-----------------------------------------------------------*/
+
+static inline float prvLog( float fX, bool bPrecise )
+{
+	float fM, fS, fZ, fP, fE;
+	uint32_t ulBits;
+	int32_t lExponent = 0;
+
+	if( fX != fX )
+		return NAN;
+	if( fX < 0.0f )
+		return NAN;
+	if( fX == 0.0f )
+		return -INFINITY;
+	if( fX > FLT_MAX )
+		return fX;
+
+	/* Subnormal: take it to normal range */
+	if( fX < FLT_MIN )
+	{
+		fX *= 16777216.0f;		/* 2^24 */
+		lExponent = -24;
+	}
+
+	/* x = m * 2^e, m on [sqrt(2)/2, sqrt(2)) */
+	ulBits = prvToBits( fX );
+	lExponent += (int32_t)( ulBits >> 23 ) - 127;
+	fM = prvFromBits( ( ulBits & 0x007FFFFFUL ) | 0x3F800000UL );
+	if( fM > fastmathSQRT2 )
+	{
+		fM *= 0.5f;
+		lExponent++;
+	}
+
+	/* log( m ) = 2 atanh( s ) = 2s + 2s * z * h( z ), with z = s^2 */
+	fS = ( fM - 1.0f ) / ( fM + 1.0f );
+	fZ = fS * fS;
+	if( bPrecise )
+		fP = ( 1.47899747e-1f * fZ + 1.99943903e-1f ) * fZ + 3.33333425e-1f;
+	else
+		fP = 3.36340407e-1f;
+	fP = 2.0f * fS + 2.0f * fS * fZ * fP;
+
+	fE = (float)lExponent;
+	return fE * fastmathLN2_HI + ( fP + fE * fastmathLN2_LO );
+}
+
+
+/*=====[Public functions implementation]===================================*/
+
+float FastMath_Sqrt( float fX, FastMath_Mode_t xMode )
+{
+	return prvSqrt( fX, xMode == fastmathPRECISE );
+}
+/*-----------------------------------------------------------*/
+
+float FastMath_Sin( float fX, FastMath_Mode_t xMode )
+{
+	if( xMode == fastmathPRECISE )
+		return prvSinPoly( fX, 0 );
+
+	return prvSinTable( fX, 0 );
+}
+/*-----------------------------------------------------------*/
+
+float FastMath_Cos( float fX, FastMath_Mode_t xMode )
+{
+	if( xMode == fastmathPRECISE )
+		return prvSinPoly( fX, 1 );
+
+	return prvSinTable( fX, fastmathSIN_TABLE_SIZE );
+}
+/*-----------------------------------------------------------*/
+
+float FastMath_Atan2( float fY, float fX, FastMath_Mode_t xMode )
+{
+	return prvAtan2( fY, fX, xMode == fastmathPRECISE );
+}
+/*-----------------------------------------------------------*/
+
+float FastMath_Exp( float fX, FastMath_Mode_t xMode )
+{
+	return prvExp( fX, xMode == fastmathPRECISE );
+}
+/*-----------------------------------------------------------*/
+
+float FastMath_Log( float fX, FastMath_Mode_t xMode )
+{
+	return prvLog( fX, xMode == fastmathPRECISE );
+}
+/*-----------------------------------------------------------*/
+
+void FastMath_Vector( FastMath_Function_t xFunction, FastMath_Mode_t xMode, const float *pfIn, float *pfOut, size_t uxCount )
+{
+	size_t loop;
+
+	/* One loop per kernel and mode, so nothing is decided inside them */
+	switch( xFunction )
+	{
+		case fastmathSQRT:
+			if( xMode == fastmathPRECISE )
+				for( loop = 0 ; loop < uxCount ; loop++ )	pfOut[loop] = prvSqrt( pfIn[loop], true );
+			else
+				for( loop = 0 ; loop < uxCount ; loop++ )	pfOut[loop] = prvSqrt( pfIn[loop], false );
+			break;
+
+		case fastmathSIN:
+			if( xMode == fastmathPRECISE )
+				for( loop = 0 ; loop < uxCount ; loop++ )	pfOut[loop] = prvSinPoly( pfIn[loop], 0 );
+			else
+				for( loop = 0 ; loop < uxCount ; loop++ )	pfOut[loop] = prvSinTable( pfIn[loop], 0 );
+			break;
+
+		case fastmathCOS:
+			if( xMode == fastmathPRECISE )
+				for( loop = 0 ; loop < uxCount ; loop++ )	pfOut[loop] = prvSinPoly( pfIn[loop], 1 );
+			else
+				for( loop = 0 ; loop < uxCount ; loop++ )	pfOut[loop] = prvSinTable( pfIn[loop], fastmathSIN_TABLE_SIZE );
+			break;
+
+		case fastmathEXP:
+			if( xMode == fastmathPRECISE )
+				for( loop = 0 ; loop < uxCount ; loop++ )	pfOut[loop] = prvExp( pfIn[loop], true );
+			else
+				for( loop = 0 ; loop < uxCount ; loop++ )	pfOut[loop] = prvExp( pfIn[loop], false );
+			break;
+
+		case fastmathLOG:
+		default:
+			if( xMode == fastmathPRECISE )
+				for( loop = 0 ; loop < uxCount ; loop++ )	pfOut[loop] = prvLog( pfIn[loop], true );
+			else
+				for( loop = 0 ; loop < uxCount ; loop++ )	pfOut[loop] = prvLog( pfIn[loop], false );
+			break;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void FastMath_Atan2Vector( FastMath_Mode_t xMode, const float *pfY, const float *pfX, float *pfOut, size_t uxCount )
+{
+	size_t loop;
+
+	if( xMode == fastmathPRECISE )
+		for( loop = 0 ; loop < uxCount ; loop++ )	pfOut[loop] = prvAtan2( pfY[loop], pfX[loop], true );
+	else
+		for( loop = 0 ; loop < uxCount ; loop++ )	pfOut[loop] = prvAtan2( pfY[loop], pfX[loop], false );
+}
@@ -0,0 +1,118 @@
+/*
+ * app_baud.c
+ *
+ *  Negotiation of the baud rate of the command line at runtime.
+ */
+
+/*=====[Includes]===========================================================*/
+
+#include "app_baud.h"
+#include <string.h>
+
+
+/*=====[Definitions of private data types]==================================*/
+
+/**
+ * States of the negotiation.
+ */
+typedef enum
+{
+	baudIDLE = 0,			/**< Rate in use confirmed */
+	baudREQUESTED,			/**< Waiting the answer of "baud" to be sent */
+	baudCONFIRMING			/**< New rate in use, waiting the confirmation */
+} prvBaudState_t;
+
+
+/*=====[Private global variables definition]=====================================*/
+
+static prvBaudState_t xState = baudIDLE;
+static Baud_SetRate_t pxSetRateFunction = NULL;
+static uint32_t ulCurrentRate = baudDEFAULT_RATE;		/**< Rate in use */
+static uint32_t ulPreviousRate = baudDEFAULT_RATE;		/**< Rate restored if not confirmed */
+static uint32_t ulTimeout = 0;							/**< Ticks to wait the confirmation */
+static uint32_t ulSwitchTime = 0;						/**< Tick when the new rate was set */
+
+
+/*=====[Public functions implementation]===================================*/
+
+void app_baudInit( Baud_SetRate_t pxSetRate, uint32_t ulRate, uint32_t ulTimeoutTicks )
+{
+	pxSetRateFunction = pxSetRate;
+	ulCurrentRate = ulRate;
+	ulPreviousRate = ulRate;
+	ulTimeout = ulTimeoutTicks;
+	xState = baudIDLE;
+}
+/*-----------------------------------------------------------*/
+
+bool app_baudRequest( uint32_t ulRate )
+{
+	if( xState != baudIDLE )
+		return false;
+
+	ulPreviousRate = ulCurrentRate;
+	ulCurrentRate = ulRate;
+	xState = baudREQUESTED;
+
+	return true;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t app_baudGetRate( void )
+{
+	return ulCurrentRate;
+}
+/*-----------------------------------------------------------*/
+
+bool app_baudIsConfirming( void )
+{
+	return ( xState == baudCONFIRMING );
+}
+/*-----------------------------------------------------------*/
+
+bool app_baudIsPending( void )
+{
+	return ( xState != baudIDLE );
+}
+/*-----------------------------------------------------------*/
+
+bool app_baudConfirm( const char *pcLine )
+{
+	if( ( xState != baudCONFIRMING ) || ( strcmp( pcLine, baudCONFIRMATION ) != 0 ) )
+		return false;
+
+	xState = baudIDLE;
+
+	return true;
+}
+/*-----------------------------------------------------------*/
+
+const char* app_baudUpdate( uint32_t ulNow )
+{
+	switch( xState )
+	{
+		case baudREQUESTED:
+			/* The answer was sent at the previous rate, now both ends change */
+			pxSetRateFunction( ulCurrentRate );
+			ulSwitchTime = ulNow;
+			xState = baudCONFIRMING;
+			break;
+
+		case baudCONFIRMING:
+			/* Nothing valid arrived: the client could not follow, go back */
+			if( ulNow - ulSwitchTime > ulTimeout )
+			{
+				ulCurrentRate = ulPreviousRate;
+				pxSetRateFunction( ulCurrentRate );
+				xState = baudIDLE;
+				return "baud: sin confirmación, vuelve a la velocidad anterior\r\n";
+			}
+			break;
+
+		case baudIDLE:
+		default:
+			break;
+	}
+
+	return NULL;
+}
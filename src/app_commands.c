@@ -8,91 +8,350 @@
 /*=====[Includes]===========================================================*/
 
 #include "CLI.h"
+#include "decimal.h"
+#include "fastmath.h"
+#include "app_stats.h"
+#include "app_trace.h"
+#include "app_baud.h"
 #include "sapi.h"
 #include "printf.h"
 #include <stdlib.h>
+#include <ctype.h>
 #include <stdbool.h>
 #include <float.h>
-#include <ctype.h>
 #include <string.h>
 
 
+/*=====[Definitions and macros]=============================================*/
+
+#define appBENCH_MAX_ITERATIONS		100000		/**< Max number of iterations accepted by "bench" */
+#define appBENCH_OUT_BUFFER_SIZE	256			/**< Size of the buffer where the benchmarked output is discarded */
+#define appBENCH_SLICE_CYCLES		( SystemCoreClock / 100 )	/**< Cycles "bench" runs before yielding (10ms) */
+
+/* Calls of one run of the benchmarked command before it is taken as hung.
+The longest legitimate run is "trace dump" of a full ring: about
+traceBUFFER_SIZE * appTRACE_LINE_SIZE / appBENCH_OUT_BUFFER_SIZE calls */
+#ifndef appBENCH_MAX_CALLS
+	#define appBENCH_MAX_CALLS		1024
+#endif
+
+#define appTRACE_LINE_SIZE			20			/**< Characters of one record on "trace dump": "tttttttt e aaaa\r\n" */
+
+#define appOPERAND_DIGITS			6			/**< Max digits of the operands of arithmetic commands with double engine */
+
+#define appMATH_MAX_OPERANDS		8			/**< Max values of one math function command (sqrt, sin, ...) */
+
+
 /*=====[Enumerations]=======================================================*/
 
 /**
- * Enumerate flags for validation numbers.
- * This flags are used on private functions prvValidateNumber and prvValidateExtractParammeters.
+ * Engines that can solve arithmetic commands.
  */
-enum Validation_e {
-	NON_NUMERIC = 0x0,		/**< Flag for non numeric */
-	OVERFLOW	= 0x1,		/**< Flag for overflow  */
-	NUMERIC		= 0x2		/**< Flag for numeric */
-};
+typedef enum {
+	appENGINE_DOUBLE = 0,	/**< double precision floating point, operands of up to 6 digits */
+	appENGINE_DECIMAL		/**< exact decimal numbers, operands of up to cliMAX_NUMBER_LENGTH characters */
+} appEngine_t;
 
 
 /*=====[Private functions declarations]=====================================*/
 
 /*
- * Take a string and return if it is a valid number or not, and if it fit the requirements.
- * @param	pcNumber	pointer to string that contains the number to validate.
- * @param	uxNumber	size of number to validate.
- * @return	return a flag type Validation_e. NON_NUMERIC, OVERFLOW or NUMERIC.
+ * Solve an arithmetic operation between the two operands, with the engine selected.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pxArguments			Operands already validated.
+ * @param	cOperation			'+', '-', '*' or '/'.
+ * @return	pdFALSE, function always end.
  */
-static int prvValidateNumber(const char* pcNumber, size_t uxNumber);
+static int prvArithmetic( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, char cOperation );
 
 /*
- * Validate and extract two numbers after the command.
- * Validate and extract two numbers after the command, and save them as doubles on pdParam1 and pdParam2.
- * If fail, then a string is saved on pcWriteBuffer specifying the motive.
- * @param	pcWriteBuffer	Pointer output buffer string.
- * @param	xWriteBufferLen	Size of output buffer.
- * @param	pcCommandString	String with command and parameters.
- * @param	pdParam1		Pointer to storage the first parameter if valid.
- * @param	pdParam2		Pointer to storage the second parameter if valid.
- * @return	return pdPASS if both parameters are valid, and pdFAIL if at least one parameter is invalid or overflow.
+ * Convert a list of numbers separated by spaces.
+ * @param	pcWriteBuffer		Buffer to store the error message.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pcOperands			String with the numbers, null terminated.
+ * @param	pfOperands			Where the numbers are stored, appMATH_MAX_OPERANDS at most.
+ * @param	puxCount			Amount of numbers stored.
+ * @return	pdPASS if all of them are numbers, otherwise pdFAIL and the error on pcWriteBuffer.
+ */
+static int prvParseOperands( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcOperands, float *pfOperands, size_t *puxCount );
+
+/*
+ * Write a list of results separated by spaces.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pfResults			Results to write.
+ * @param	uxCount				Amount of results.
+ */
+static void prvPrintResults( char *pcWriteBuffer, size_t xWriteBufferLen, const float *pfResults, size_t uxCount );
+
+/*
+ * Solve a math function of one argument on all the operands, with the mode selected.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pxArguments			List of operands, not validated yet.
+ * @param	xFunction			Function to solve.
+ * @return	pdFALSE, function always end.
  */
-static int prvValidateExtractParammeters ( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString , double* pdParam1, double* pdParam2);
+static int prvMathFunction( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, FastMath_Function_t xFunction );
 
 /*
  * This function handle "suma" command.
  * @param	pcWriteBuffer	Buffer to store output string.
  * @param	xWriteBufferLen	Size of output buffer.
- * @param	pcCommandString	
-		String to analyze.
+ * @param	pxArguments			Operands already validated.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
  * @return	pdTRUE if has to be called again. pdFALSE if function ended.
  */
-static int prvCommand_Suma( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static int prvCommand_Suma( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
 
 /*
  * This function handle "resta" command.
  * @param	pcWriteBuffer	Buffer to store output string.
  * @param	xWriteBufferLen	Size of output buffer.
- * @param	pcCommandString	String to analyze.
+ * @param	pxArguments			Operands already validated.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
  * @return	pdTRUE if has to be called again. pdFALSE if function ended.
  */
-static int prvCommand_Resta( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static int prvCommand_Resta( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
 
 /*
  * This function handle "multiplica" command.
  * @param	pcWriteBuffer	Buffer to store output string.
  * @param	xWriteBufferLen	Size of output buffer.
- * @param	pcCommandString	String to analyze.
+ * @param	pxArguments			Operands already validated.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
  * @return	pdTRUE if has to be called again. pdFALSE if function ended.
  */
-static int prvCommand_Multiplica( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static int prvCommand_Multiplica( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
 
 /*
  * This function handle "divide" command.
  * @param	pcWriteBuffer	Buffer to store output string.
  * @param	xWriteBufferLen	Size of output buffer.
+ * @param	pxArguments			Operands already validated.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Divide( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
+
+/*
+ * This function handle "bench" command.
+ * Run the command line that follows the number of iterations through CLI_ProcessCommand,
+ * discarding its output, and report the cycles spent.
+ * @param	pcWriteBuffer	Buffer to store output string.
+ * @param	xWriteBufferLen	Size of output buffer.
+ * @param	pxArguments			Number of iterations and command line to run.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Bench( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
+
+
+/*
+ * This function handle "motor" command.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pxArguments			Engine selected.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Motor( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
+
+
+/*
+ * This function handle "stream" command.
+ * @param	pcWriteBuffer	Buffer to store output string.
+ * @param	xWriteBufferLen	Size of output buffer.
+ * @param	pcCommandString	String to analyze.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Stream( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * This function handle "summary" command.
+ * @param	pcWriteBuffer	Buffer to store output string.
+ * @param	xWriteBufferLen	Size of output buffer.
  * @param	pcCommandString	String to analyze.
  * @return	pdTRUE if has to be called again. pdFALSE if function ended.
  */
-static int prvCommand_Divide( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+static int prvCommand_Summary( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString );
+
+/*
+ * This function handle "trace" command.
+ * "trace dump" write the records in hexadecimal, some of them on each call.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pxArguments			Action selected.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Trace( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
+
+/*
+ * This function handle "sqrt" command.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pxArguments			List of operands.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Sqrt( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
+
+/*
+ * This function handle "sin" command.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pxArguments			List of operands.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Sin( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
+
+/*
+ * This function handle "cos" command.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pxArguments			List of operands.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Cos( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
+
+/*
+ * This function handle "atan2" command.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pxArguments			List of pairs y x.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Atan2( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
+
+/*
+ * This function handle "exp" command.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pxArguments			List of operands.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Exp( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
+
+/*
+ * This function handle "log" command.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pxArguments			List of operands.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Log( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
+
+/*
+ * This function handle "modo" command.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pxArguments			Mode selected.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Modo( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
+
+/*
+ * This function handle "baud" command.
+ * The rate changes after the answer is sent, see app_baud.h.
+ * @param	pcWriteBuffer		Buffer to store output string.
+ * @param	xWriteBufferLen		Size of output buffer.
+ * @param	pxArguments			New baud rate.
+ * @param	xNumberOfArguments	Number of elements of pxArguments.
+ * @return	pdTRUE if has to be called again. pdFALSE if function ended.
+ */
+static int prvCommand_Baud( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments );
 
 
 /*=====[Private global variables definition]=====================================*/
 
+static appEngine_t xEngine = appENGINE_DOUBLE;		/**< Engine used by arithmetic commands */
+static FastMath_Mode_t xMathMode = fastmathFAST;	/**< Mode used by math function commands */
+
+/**
+ *  Names of the engines, in the same order as appEngine_t.
+ */
+static const char * const pcEngineNames[] = { "double", "decimal", NULL };
+
+/**
+ *  Actions of "trace" command.
+ */
+static const char * const pcTraceActions[] = { "dump", "clear", NULL };
+
+/**
+ *  Names of the modes of math functions, in the same order as FastMath_Mode_t.
+ */
+static const char * const pcMathModeNames[] = { "rapido", "preciso", NULL };
+
+/**
+ *  Parameters of arithmetic commands.
+ *  Two decimal numbers with optional negative sign and decimal point.
+ *  The amount of digits depends on the engine, and it is checked by prvArithmetic.
+ */
+static const CLI_Parameter_t xOperandsParameters[] =
+{
+	{ cliPARAM_NUMBER, -DBL_MAX, DBL_MAX, 0, NULL },
+	{ cliPARAM_NUMBER, -DBL_MAX, DBL_MAX, 0, NULL }
+};
+
+/**
+ *  Parameters of "bench" command.
+ *  Number of iterations and the command line to run.
+ */
+static const CLI_Parameter_t xBenchParameters[] =
+{
+	{ cliPARAM_INTEGER, 1, appBENCH_MAX_ITERATIONS, 0, NULL },
+	{ cliPARAM_VARIADIC, 0, 0, 0, NULL }
+};
+
+/**
+ *  Parameters of "motor" command.
+ */
+static const CLI_Parameter_t xMotorParameters[] =
+{
+	{ cliPARAM_KEYWORD, 0, 0, 0, pcEngineNames }
+};
+
+/**
+ *  Parameters of "trace" command.
+ */
+static const CLI_Parameter_t xTraceParameters[] =
+{
+	{ cliPARAM_KEYWORD, 0, 0, 0, pcTraceActions }
+};
+
+/**
+ *  Parameters of math function commands.
+ *  A list of numbers, validated by prvParseOperands.
+ */
+static const CLI_Parameter_t xMathParameters[] =
+{
+	{ cliPARAM_VARIADIC, 0, 0, 0, NULL }
+};
+
+/**
+ *  Parameters of "modo" command.
+ */
+static const CLI_Parameter_t xModoParameters[] =
+{
+	{ cliPARAM_KEYWORD, 0, 0, 0, pcMathModeNames }
+};
+
+/**
+ *  Parameters of "baud" command.
+ */
+static const CLI_Parameter_t xBaudParameters[] =
+{
+	{ cliPARAM_INTEGER, baudMIN_RATE, baudMAX_RATE, 0, NULL }
+};
+
 /**
  *  The definition of the "suma" command.
  *  This command will add two decimal numbers. Only accept 6 digit numbers and a negative sign and decimal point.
@@ -100,9 +359,11 @@ static int prvCommand_Divide( char *pcWriteBuffer, size_t xWriteBufferLen, const
 static const CLI_Command_Definition_t sSumaCommand =
 {
 	"suma",
-	"\r\nsuma:\r\n realiza la sumatoria de dos números decimales. Acepta signo y/o punto decimal, y números de hasta 6 dígitos\r\n",
-	prvCommand_Suma,
-	2
+	"\r\nsuma:\r\n realiza la sumatoria de dos números decimales. Acepta signo y/o punto decimal, y números de hasta 6 dígitos (80 caracteres con motor decimal)\r\n",
+	NULL,
+	2,
+	xOperandsParameters,
+	prvCommand_Suma
 };
 
 /**
@@ -112,9 +373,11 @@ static const CLI_Command_Definition_t sSumaCommand =
 static const CLI_Command_Definition_t sRestaCommand =
 {
 	"resta",
-	"\r\nresta:\r\n realiza la resta de dos números decimales. Acepta signo y/o punto decimal, y números de hasta 6 dígitos\r\n",
-	prvCommand_Resta,
-	2
+	"\r\nresta:\r\n realiza la resta de dos números decimales. Acepta signo y/o punto decimal, y números de hasta 6 dígitos (80 caracteres con motor decimal)\r\n",
+	NULL,
+	2,
+	xOperandsParameters,
+	prvCommand_Resta
 };
 
 /**
@@ -124,9 +387,11 @@ static const CLI_Command_Definition_t sRestaCommand =
 static const CLI_Command_Definition_t sMultiplicaCommand =
 {
 	"multiplica",
-	"\r\nmultiplica:\r\n realiza la multiplicación de dos números decimales. Acepta signo y/o punto decimal, y números de hasta 6 dígitos\r\n",
-	prvCommand_Multiplica,
-	2
+	"\r\nmultiplica:\r\n realiza la multiplicación de dos números decimales. Acepta signo y/o punto decimal, y números de hasta 6 dígitos (80 caracteres con motor decimal)\r\n",
+	NULL,
+	2,
+	xOperandsParameters,
+	prvCommand_Multiplica
 };
 
 /**
@@ -136,172 +401,762 @@ static const CLI_Command_Definition_t sMultiplicaCommand =
 static const CLI_Command_Definition_t sDivideCommand =
 {
 	"divide",
-	"\r\ndivide:\r\n realiza la divición de dos números decimales. El primer número es el numerador, y el segundo es el denominador.\r\nAcepta signo y/o punto decimal, y números de hasta 6 dígitos\r\n",
-	prvCommand_Divide,
-	2
+	"\r\ndivide:\r\n realiza la divición de dos números decimales. El primer número es el numerador, y el segundo es el denominador.\r\nAcepta signo y/o punto decimal, y números de hasta 6 dígitos (80 caracteres con motor decimal)\r\n",
+	NULL,
+	2,
+	xOperandsParameters,
+	prvCommand_Divide
+};
+
+/**
+ *  The definition of the "bench" command.
+ *  This command will run any registered command n times and report the cycles spent.
+ */
+static const CLI_Command_Definition_t sBenchCommand =
+{
+	"bench",
+	"\r\nbench:\r\n ejecuta n veces el comando indicado y reporta los ciclos consumidos (total, mínimo, máximo, promedio) y las ejecuciones por segundo.\r\nEj: bench 1000 suma 1.5 2\r\n",
+	NULL,
+	2,
+	xBenchParameters,
+	prvCommand_Bench
 };
 
+/**
+ *  The definition of the "motor" command.
+ *  This command will select the engine used by arithmetic commands.
+ */
+static const CLI_Command_Definition_t sMotorCommand =
+{
+	"motor",
+	"\r\nmotor:\r\n selecciona el motor de las operaciones aritméticas. double (por defecto) o decimal (resultado exacto, divisiones con 20 decimales)\r\n",
+	NULL,
+	1,
+	xMotorParameters,
+	prvCommand_Motor
+};
+
+/**
+ *  The definition of the "stream" command.
+ *  This command will enter stream mode, where each line is a sample for running statistics.
+ */
+static const CLI_Command_Definition_t sStreamCommand =
+{
+	"stream",
+	"\r\nstream:\r\n descarta las muestras anteriores y entra en modo stream: cada línea siguiente es un número que se acumula en las estadísticas, sin respuesta. Una etiqueta al inicio de la línea (#42) se descarta. ETX (Ctrl+C) para salir\r\n",
+	prvCommand_Stream,
+	0,
+	NULL,
+	NULL
+};
+
+/**
+ *  The definition of the "summary" command.
+ *  This command will report the running statistics of the samples received on stream mode.
+ */
+static const CLI_Command_Definition_t sSummaryCommand =
+{
+	"summary",
+	"\r\nsummary:\r\n muestra las estadísticas de las muestras recibidas en modo stream\r\n",
+	prvCommand_Summary,
+	0,
+	NULL,
+	NULL
+};
+
+/**
+ *  The definition of the "trace" command.
+ *  This command will write or clear the trace of events.
+ */
+static const CLI_Command_Definition_t sTraceCommand =
+{
+	"trace",
+	"\r\ntrace:\r\n trace dump: escribe los eventos registrados (hex: ciclos evento argumento), convertir con tools/trace2chrome.py\r\n trace clear: descarta los eventos\r\n",
+	NULL,
+	1,
+	xTraceParameters,
+	prvCommand_Trace
+};
+
+/**
+ *  The definition of the "sqrt" command.
+ *  This command will calculate the square root of a list of numbers.
+ */
+static const CLI_Command_Definition_t sSqrtCommand =
+{
+	"sqrt",
+	"\r\nsqrt:\r\n raíz cuadrada de uno o más números (hasta 8), según el modo seleccionado. Ej: sqrt 2 10.5\r\n",
+	NULL,
+	1,
+	xMathParameters,
+	prvCommand_Sqrt
+};
+
+/**
+ *  The definition of the "sin" command.
+ *  This command will calculate the sine of a list of angles.
+ */
+static const CLI_Command_Definition_t sSinCommand =
+{
+	"sin",
+	"\r\nsin:\r\n seno de uno o más ángulos en radianes (hasta 8), de hasta 8192 en valor absoluto\r\n",
+	NULL,
+	1,
+	xMathParameters,
+	prvCommand_Sin
+};
+
+/**
+ *  The definition of the "cos" command.
+ *  This command will calculate the cosine of a list of angles.
+ */
+static const CLI_Command_Definition_t sCosCommand =
+{
+	"cos",
+	"\r\ncos:\r\n coseno de uno o más ángulos en radianes (hasta 8), de hasta 8192 en valor absoluto\r\n",
+	NULL,
+	1,
+	xMathParameters,
+	prvCommand_Cos
+};
+
+/**
+ *  The definition of the "atan2" command.
+ *  This command will calculate the angle of a list of points.
+ */
+static const CLI_Command_Definition_t sAtan2Command =
+{
+	"atan2",
+	"\r\natan2:\r\n ángulo en radianes del punto (x, y), de uno o más pares y x (hasta 4 pares). Ej: atan2 1 -1\r\n",
+	NULL,
+	1,
+	xMathParameters,
+	prvCommand_Atan2
+};
+
+/**
+ *  The definition of the "exp" command.
+ *  This command will calculate the exponential of a list of numbers.
+ */
+static const CLI_Command_Definition_t sExpCommand =
+{
+	"exp",
+	"\r\nexp:\r\n exponencial de uno o más números (hasta 8), menores a 88.7\r\n",
+	NULL,
+	1,
+	xMathParameters,
+	prvCommand_Exp
+};
+
+/**
+ *  The definition of the "log" command.
+ *  This command will calculate the natural logarithm of a list of numbers.
+ */
+static const CLI_Command_Definition_t sLogCommand =
+{
+	"log",
+	"\r\nlog:\r\n logaritmo natural de uno o más números positivos (hasta 8)\r\n",
+	NULL,
+	1,
+	xMathParameters,
+	prvCommand_Log
+};
+
+/**
+ *  The definition of the "modo" command.
+ *  This command will select the accuracy of math function commands.
+ */
+static const CLI_Command_Definition_t sModoCommand =
+{
+	"modo",
+	"\r\nmodo:\r\n selecciona la exactitud de sqrt, sin, cos, atan2, exp y log: rapido (por defecto, error relativo hasta 2e-3) o preciso (error cercano a la resolución de float). Ciclos por valor estimados, no medidos: rapido 20 a 185, preciso 30 a 250\r\n",
+	NULL,
+	1,
+	xModoParameters,
+	prvCommand_Modo
+};
+
+/**
+ *  The definition of the "baud" command.
+ *  This command will change the baud rate of the command line.
+ */
+static const CLI_Command_Definition_t sBaudCommand =
+{
+	"baud",
+	"\r\nbaud:\r\n cambia la velocidad de la línea (9600 a 12000000). Luego de la respuesta, enviar \"baud ok\" a la nueva velocidad antes de 2 s, si no vuelve a la anterior. Ver tools/baud.py\r\n",
+	NULL,
+	1,
+	xBaudParameters,
+	prvCommand_Baud
+};
+
 
 /*=====[Private functions implementation]===================================*/
 
-static int prvValidateNumber(const char* pcNumber, size_t uxNumber)
+static int prvArithmetic( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, char cOperation )
 {
-	bool bDecimalPoint = false, bNegative = false;
-	const char* pcNumberCheck = pcNumber;
-	size_t uxNumberSize = uxNumber;
+	Decimal_t xNum1, xNum2, xRes;
+	Decimal_Status_t xStatus;
+	size_t uxLen;
+	double dRes;
 
-	/* Check if no overflow size number entered */
-	if( uxNumberSize > (FLT_DIG + 2) )
-		return OVERFLOW;
+	if( xEngine == appENGINE_DOUBLE )
+	{
+		/* More digits would not be exact with double */
+		if( ( pxArguments[0].ucDigits > appOPERAND_DIGITS ) || ( pxArguments[1].ucDigits > appOPERAND_DIGITS ) )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "El número excede el permitido\r\n" );
+			return pdFALSE;
+		}
+
+		switch( cOperation )
+		{
+			case '+':	dRes = pxArguments[0].dNumber + pxArguments[1].dNumber;	break;
+			case '-':	dRes = pxArguments[0].dNumber - pxArguments[1].dNumber;	break;
+			case '*':	dRes = pxArguments[0].dNumber * pxArguments[1].dNumber;	break;
+			default:
+				/* If denominator is zero, then error */
+				if( pxArguments[1].dNumber == 0 )
+				{
+					snprintf( pcWriteBuffer, xWriteBufferLen, "ERROR\r\n");
+					return pdFALSE;
+				}
+				dRes = pxArguments[0].dNumber / pxArguments[1].dNumber;
+				break;
+		}
+
+		/* format and print */
+		snprintf( pcWriteBuffer, xWriteBufferLen, "%g\r\n", dRes );
+		return pdFALSE;
+	}
+
+	/* Decimal engine: all the limbs of the previous command are released */
+	Decimal_Reset();
+
+	xStatus = Decimal_Parse( &xNum1, pxArguments[0].pcString, pxArguments[0].xStringLength );
+	if( xStatus == decimalOK )
+		xStatus = Decimal_Parse( &xNum2, pxArguments[1].pcString, pxArguments[1].xStringLength );
 
-	/* Check if negative */
-	if( *pcNumberCheck == '-')
+	if( xStatus == decimalOK )
 	{
-		bNegative = true;
-		pcNumberCheck++;
-		uxNumberSize--;
+		switch( cOperation )
+		{
+			case '+':	xStatus = Decimal_Add( &xRes, &xNum1, &xNum2 );	break;
+			case '-':	xStatus = Decimal_Sub( &xRes, &xNum1, &xNum2 );	break;
+			case '*':	xStatus = Decimal_Mul( &xRes, &xNum1, &xNum2 );	break;
+			default:	xStatus = Decimal_Div( &xRes, &xNum1, &xNum2 );	break;
+		}
+	}
+
+	/* Leave place for the new line */
+	if( ( xStatus == decimalOK ) && ( xWriteBufferLen > 2 ) )
+		xStatus = Decimal_Format( &xRes, pcWriteBuffer, xWriteBufferLen - 2 );
+
+	switch( xStatus )
+	{
+		case decimalOK:
+			/* format and print */
+			uxLen = strlen( pcWriteBuffer );
+			pcWriteBuffer[uxLen++] = '\r';
+			pcWriteBuffer[uxLen++] = '\n';
+			pcWriteBuffer[uxLen] = '\0';
+			break;
+		case decimalERR_DIV_ZERO:
+			snprintf( pcWriteBuffer, xWriteBufferLen, "ERROR\r\n");
+			break;
+		case decimalERR_SYNTAX:
+			snprintf( pcWriteBuffer, xWriteBufferLen, "Ingrese un número correcto\r\n" );
+			break;
+		default:
+			snprintf( pcWriteBuffer, xWriteBufferLen, "El número excede el permitido\r\n" );
+			break;
 	}
 
-	for( ; uxNumberSize > 0 ; uxNumberSize--, pcNumberCheck++ )
+	return pdFALSE;
+}
+/*--------------------------------------------------------------------*/
+
+static int prvParseOperands( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcOperands, float *pfOperands, size_t *puxCount )
+{
+	size_t uxLength;
+	double dValue;
+
+	*puxCount = 0;
+
+	while( *pcOperands != '\0' )
 	{
-		/* Check only one decimal point entered */
-		if( *pcNumberCheck == '.' )
+		if( *pcOperands == ' ' )
 		{
-			if ( bDecimalPoint )
-				break;
-			else
-				bDecimalPoint = true;
+			pcOperands++;
+			continue;
+		}
+
+		if( *puxCount == appMATH_MAX_OPERANDS )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "Máximo %d números\r\n", appMATH_MAX_OPERANDS );
+			return pdFAIL;
+		}
+
+		/* Optional sign, digits and decimal point, the same rules than typed
+		parameters. strtod alone would also take exponents, hex, inf and nan */
+		uxLength = strcspn( pcOperands, " " );
+		if( uxLength > cliMAX_NUMBER_LENGTH )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "El número excede el permitido\r\n" );
+			return pdFAIL;
+		}
+		if( !CLI_IsNumber( pcOperands, uxLength ) )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "Ingrese un número correcto\r\n" );
+			return pdFAIL;
+		}
+		dValue = strtod( pcOperands, NULL );
+
+		/* It has to fit on a float */
+		if( ( dValue > FLT_MAX ) || ( dValue < -FLT_MAX ) )
+		{
+			snprintf( pcWriteBuffer, xWriteBufferLen, "El número excede el permitido\r\n" );
+			return pdFAIL;
 		}
-		else
+
+		pfOperands[( *puxCount )++] = (float)dValue;
+		pcOperands += uxLength;
+	}
+
+	return pdPASS;
+}
+/*--------------------------------------------------------------------*/
+
+static void prvPrintResults( char *pcWriteBuffer, size_t xWriteBufferLen, const float *pfResults, size_t uxCount )
+{
+	size_t uxLen = 0;
+	size_t loop;
+
+	for( loop = 0 ; ( loop < uxCount ) && ( uxLen < xWriteBufferLen ) ; loop++ )
+		uxLen += snprintf( pcWriteBuffer + uxLen, xWriteBufferLen - uxLen, ( loop == 0 ) ? "%g" : " %g", (double)pfResults[loop] );
+
+	if( uxLen < xWriteBufferLen )
+		snprintf( pcWriteBuffer + uxLen, xWriteBufferLen - uxLen, "\r\n" );
+}
+/*--------------------------------------------------------------------*/
+
+static int prvMathFunction( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, FastMath_Function_t xFunction )
+{
+	float fValues[appMATH_MAX_OPERANDS];
+	size_t uxCount, loop;
+
+	if( prvParseOperands( pcWriteBuffer, xWriteBufferLen, pxArguments[0].pcString, fValues, &uxCount ) != pdPASS )
+		return pdFALSE;
+
+	/* Outside the domain the result is not a number or it is not accurate */
+	for( loop = 0 ; loop < uxCount ; loop++ )
+	{
+		switch( xFunction )
 		{
-			/* Check character is numeric */
-			if( isdigit( *pcNumberCheck ) == 0 )
+			case fastmathSQRT:
+				if( fValues[loop] < 0.0f )
+				{
+					snprintf( pcWriteBuffer, xWriteBufferLen, "ERROR\r\n");
+					return pdFALSE;
+				}
+				break;
+			case fastmathLOG:
+				if( fValues[loop] <= 0.0f )
+				{
+					snprintf( pcWriteBuffer, xWriteBufferLen, "ERROR\r\n");
+					return pdFALSE;
+				}
+				break;
+			case fastmathSIN:
+			case fastmathCOS:
+				if( ( fValues[loop] > fastmathTRIG_MAX_ARGUMENT ) || ( fValues[loop] < -fastmathTRIG_MAX_ARGUMENT ) )
+				{
+					snprintf( pcWriteBuffer, xWriteBufferLen, "El número excede el permitido\r\n" );
+					return pdFALSE;
+				}
+				break;
+			case fastmathEXP:
+			default:
+				if( fValues[loop] > fastmathEXP_MAX_ARGUMENT )
+				{
+					snprintf( pcWriteBuffer, xWriteBufferLen, "El número excede el permitido\r\n" );
+					return pdFALSE;
+				}
 				break;
 		}
 	}
 
-	/* If break before because not numeric or finish with point  */
-	if( ( uxNumberSize != 0 ) || ( bDecimalPoint && *pcNumberCheck == '.' ) )	// if break after finish or finish with point
-		return NON_NUMERIC;
+	/* All the operands at once, results over the operands */
+	FastMath_Vector( xFunction, xMathMode, fValues, fValues, uxCount );
+
+	prvPrintResults( pcWriteBuffer, xWriteBufferLen, fValues, uxCount );
+
+	return pdFALSE;
+}
+/*--------------------------------------------------------------------*/
+
+static int prvCommand_Suma( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
+{
+	( void ) xNumberOfArguments;
 
-	/* If number larger than expected */
-	if ( (uxNumber > 6 	&& !bNegative 	&& !bDecimalPoint)		||				// if not negative and not decimal but larger than 6 digits
-		 (uxNumber > 7 	&&  bNegative 	&& !bDecimalPoint)		||				// if negative but not decimal but larger than 7 digits
-		 (uxNumber > 7 	&& !bNegative 	&&  bDecimalPoint)						// if not negative but decimal but larger than 7 digits
-		)
-		return OVERFLOW;
+	return prvArithmetic( pcWriteBuffer, xWriteBufferLen, pxArguments, '+' );
+}
+/*--------------------------------------------------------------------*/
 
+static int prvCommand_Resta( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
+{
+	( void ) xNumberOfArguments;
 
-	return NUMERIC;
+	return prvArithmetic( pcWriteBuffer, xWriteBufferLen, pxArguments, '-' );
 }
 /*--------------------------------------------------------------------*/
 
-static int prvValidateExtractParammeters ( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString , double* pdParam1, double* pdParam2)
+static int prvCommand_Multiplica( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
 {
-	const char *pcParam1, *pcParam2;
-	int xLenParam1, xLenParam2;
+	( void ) xNumberOfArguments;
+
+	return prvArithmetic( pcWriteBuffer, xWriteBufferLen, pxArguments, '*' );
+}
+/*--------------------------------------------------------------------*/
 
-	char cParameter1[15], cParameter2[15];
+static int prvCommand_Divide( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
+{
+	( void ) xNumberOfArguments;
 
-	int bParamValid = 0;
+	return prvArithmetic( pcWriteBuffer, xWriteBufferLen, pxArguments, '/' );
+}
+/*--------------------------------------------------------------------*/
 
-	/* Obtain pointers to parameters */
-	pcParam1 = CLI_GetParameter( pcCommandString, 1, &xLenParam1 );
-	pcParam2 = CLI_GetParameter( pcCommandString, 2, &xLenParam2 );
+static int prvCommand_Bench( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
+{
+	static char cDiscardBuffer[appBENCH_OUT_BUFFER_SIZE];	/**< Output of benchmarked command is written and discarded here */
+	static uint32_t ulDone = 0;								/**< Iterations done on previous calls */
+	static uint32_t ulMin, ulMax;
+	static uint64_t ullTotal;
+	const char *pcBenchCommand = pxArguments[1].pcString;
+	uint32_t ulIterations = (uint32_t)pxArguments[0].lInteger;
+	uint32_t ulStart, ulCycles, ulSliceStart;
+	uint32_t ulCalls;
+	int xMore;
 
-	/* Validate parameters */
-		
-	bParamValid |= prvValidateNumber( pcParam1, xLenParam1 );
-	bParamValid |= prvValidateNumber( pcParam2, xLenParam2 );
+	( void ) xNumberOfArguments;
 
-	/* if some of them is not numeric, then report error and why */
-	if( bParamValid != NUMERIC )
+	/* A nested bench would overwrite the discard buffer and measure itself */
+	if( ( strncmp( pcBenchCommand, sBenchCommand.pcCommand, strlen( sBenchCommand.pcCommand ) ) == 0 ) &&
+		( strcspn( pcBenchCommand, " " ) == strlen( sBenchCommand.pcCommand ) ) )
 	{
-		if( ( bParamValid & NON_NUMERIC ) != 0 )
-			snprintf( pcWriteBuffer, xWriteBufferLen, "Ingrese un número correcto\r\n" );
-		else if( ( bParamValid & OVERFLOW ) != 0 )
-			snprintf( pcWriteBuffer, xWriteBufferLen, "El número excede el permitido\r\n" );
+		snprintf( pcWriteBuffer, xWriteBufferLen, "No se puede medir bench con bench\r\n" );
+		return pdFALSE;
+	}
 
-		return pdFAIL;
+	/* First call: clean results */
+	if( ulDone == 0 )
+	{
+		cyclesCounterInit( SystemCoreClock );
+		ulMin = UINT32_MAX;
+		ulMax = 0;
+		ullTotal = 0;
 	}
 
-	/* copy parameters and store them in their double pointers */
-	strncpy(cParameter1, pcParam1, xLenParam1);
-	strncpy(cParameter2, pcParam2, xLenParam2);
+	/* Run iterations during one slice of time, then yield so the board keeps attending the UART */
+	ulSliceStart = cyclesCounterRead();
+	while( ( ulDone < ulIterations ) && !CLI_IsCancelRequested() &&
+		   ( cyclesCounterRead() - ulSliceStart < appBENCH_SLICE_CYCLES ) )
+	{
+		/* Time a whole command, including the calls it ask to be repeated.
+		Nothing is printed inside, so UART time is excluded */
+		ulCalls = 0;
+		ulStart = cyclesCounterRead();
+		do
+		{
+			xMore = CLI_ProcessCommand( pcBenchCommand, cDiscardBuffer, sizeof( cDiscardBuffer ) );
+		} while( ( xMore == pdTRUE ) && ( ++ulCalls < appBENCH_MAX_CALLS ) );
+		ulCycles = cyclesCounterRead() - ulStart;
 
-	*pdParam1 = strtod(cParameter1, NULL);
-	*pdParam2 = strtod(cParameter2, NULL);
+		/* Cancelled inside: the iteration is not complete, report the ones done */
+		if( xMore == cliCANCELLED )
+			break;
 
-	return pdPASS;
+		/* A command that never end would hang the board. Cancel only it, so it
+		releases its state, and report it instead of a partial timing. An ETX
+		received meanwhile stays requested for app_FSM */
+		if( xMore == pdTRUE )
+		{
+			CLI_CancelCommand( pcBenchCommand, cDiscardBuffer, sizeof( cDiscardBuffer ) );
+			snprintf( pcWriteBuffer, xWriteBufferLen, "bench: el comando no terminó en %d llamadas\r\n", appBENCH_MAX_CALLS );
+			ulDone = 0;
+			return pdFALSE;
+		}
+
+		ullTotal += ulCycles;
+		if( ulCycles < ulMin )
+			ulMin = ulCycles;
+		if( ulCycles > ulMax )
+			ulMax = ulCycles;
+		ulDone++;
+	}
+
+	if( ( ulDone < ulIterations ) && !CLI_IsCancelRequested() )
+	{
+		*pcWriteBuffer = '\0';
+		return pdTRUE;
+	}
+
+	/* Finished or cancelled: report the iterations done */
+	xMore = ( ulDone < ulIterations ) ? cliCANCELLED : pdFALSE;
+	if( ulDone == 0 )
+		*pcWriteBuffer = '\0';
+	else
+		snprintf( pcWriteBuffer, xWriteBufferLen,
+				"iteraciones: %lu\r\n"
+				"ciclos total: %llu\r\n"
+				"ciclos min: %lu\r\n"
+				"ciclos max: %lu\r\n"
+				"ciclos promedio: %lu\r\n"
+				"ejecuciones/s: %lu\r\n",
+				(unsigned long)ulDone,
+				(unsigned long long)ullTotal,
+				(unsigned long)ulMin,
+				(unsigned long)ulMax,
+				(unsigned long)( ullTotal / ulDone ),
+				(unsigned long)( ( (uint64_t)ulDone * SystemCoreClock ) / ( ullTotal ? ullTotal : 1 ) ) );
+
+	ulDone = 0;
+
+	return xMore;
+}
+/*--------------------------------------------------------------------*/
+
+static int prvCommand_Motor( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
+{
+	( void ) xNumberOfArguments;
+
+	xEngine = (appEngine_t)pxArguments[0].xKeyword;
+
+	snprintf( pcWriteBuffer, xWriteBufferLen, "motor: %s\r\n", pcEngineNames[xEngine] );
+
+	return pdFALSE;
+}
+
+/*--------------------------------------------------------------------*/
+
+static int prvCommand_Stream( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+{
+	( void ) pcCommandString;
+
+	app_statsReset();
+	app_statsSetStreaming( true );
+
+	snprintf( pcWriteBuffer, xWriteBufferLen, "stream: una muestra por línea, ETX para salir\r\n" );
+
+	return pdFALSE;
 }
 /*--------------------------------------------------------------------*/
 
-static int prvCommand_Suma( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static int prvCommand_Summary( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
 {
-	double xNum1, xNum2;
+	Stats_Summary_t xSummary;
+
+	( void ) pcCommandString;
 
-	/* validate and extract numbers entered with command */
-	if ( prvValidateExtractParammeters( pcWriteBuffer, xWriteBufferLen, pcCommandString, &xNum1, &xNum2 ) == pdFAIL )
+	app_statsGetSummary( &xSummary );
+
+	if( xSummary.ulCount == 0 )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "Sin muestras (rechazadas: %lu)\r\n", (unsigned long)xSummary.ulRejected );
 		return pdFALSE;
+	}
 
 	/* format and print */
-	snprintf( pcWriteBuffer, xWriteBufferLen, "%g\r\n", xNum1 + xNum2);
+	snprintf( pcWriteBuffer, xWriteBufferLen,
+			"muestras: %lu\r\n"
+			"rechazadas: %lu\r\n"
+			"promedio: %g\r\n"
+			"varianza: %g\r\n"
+			"min: %g\r\n"
+			"max: %g\r\n"
+			"p50: %g\r\n"
+			"p90: %g\r\n"
+			"p99: %g\r\n",
+			(unsigned long)xSummary.ulCount,
+			(unsigned long)xSummary.ulRejected,
+			xSummary.dMean,
+			xSummary.dVariance,
+			xSummary.dMin,
+			xSummary.dMax,
+			xSummary.dQuantile[0],
+			xSummary.dQuantile[1],
+			xSummary.dQuantile[2] );
 
 	return pdFALSE;
 }
+
 /*--------------------------------------------------------------------*/
 
-static int prvCommand_Resta( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static int prvCommand_Trace( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
 {
-	double xNum1, xNum2;
+	static uint32_t ulNext = 0;				/**< Next record to write on dump */
+	static bool bDumping = false;
+	const Trace_Record_t *pxRecord;
+	size_t uxLen = 0;
+
+	( void ) xNumberOfArguments;
+
+	if( pxArguments[0].xKeyword == 1 )
+	{
+		app_traceClear();
+		snprintf( pcWriteBuffer, xWriteBufferLen, "trace: vacío\r\n" );
+		return pdFALSE;
+	}
+
+	/* Not even one record fit on the buffer: the dump would never end */
+	if( xWriteBufferLen <= appTRACE_LINE_SIZE )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "Buffer pequeño\r\n" );
+		app_tracePause( false );
+		bDumping = false;
+		return pdFALSE;
+	}
+
+	/* First call: stop recording so the dump does not overwrite the records being read */
+	if( !bDumping )
+	{
+		app_tracePause( true );
+		bDumping = true;
+		ulNext = 0;
+		uxLen = snprintf( pcWriteBuffer, xWriteBufferLen, "trace: %lu eventos, %lu Hz\r\n",
+				(unsigned long)app_traceCount(), (unsigned long)SystemCoreClock );
+	}
+
+	/* As many records as fit on output buffer */
+	while( ( ulNext < app_traceCount() ) && ( uxLen + appTRACE_LINE_SIZE < xWriteBufferLen ) && !CLI_IsCancelRequested() )
+	{
+		pxRecord = app_traceGet( ulNext++ );
+		uxLen += snprintf( pcWriteBuffer + uxLen, xWriteBufferLen - uxLen, "%08lx %u %04x\r\n",
+				(unsigned long)pxRecord->ulTimestamp, pxRecord->ucEvent, pxRecord->usArgument );
+	}
 
-	/* validate and extract numbers entered with command */
-	if ( prvValidateExtractParammeters( pcWriteBuffer, xWriteBufferLen, pcCommandString, &xNum1, &xNum2 ) == pdFAIL )
+	if( !CLI_IsCancelRequested() )
+	{
+		/* More records, or no place left for the end mark */
+		if( ( ulNext < app_traceCount() ) || ( uxLen + appTRACE_LINE_SIZE >= xWriteBufferLen ) )
 			return pdTRUE;
 
-	/* format and print */
-	snprintf( pcWriteBuffer, xWriteBufferLen, "%g\r\n", xNum1 - xNum2 );
+		snprintf( pcWriteBuffer + uxLen, xWriteBufferLen - uxLen, "trace: fin\r\n" );
+	}
+
+	/* Finished or cancelled: record again from an empty ring */
+	app_traceClear();
+	app_tracePause( false );
+	bDumping = false;
+
+	return CLI_IsCancelRequested() ? cliCANCELLED : pdFALSE;
+}
+/*--------------------------------------------------------------------*/
+
+static int prvCommand_Sqrt( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
+{
+	( void ) xNumberOfArguments;
+
+	return prvMathFunction( pcWriteBuffer, xWriteBufferLen, pxArguments, fastmathSQRT );
+}
+/*--------------------------------------------------------------------*/
+
+static int prvCommand_Sin( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
+{
+	( void ) xNumberOfArguments;
+
+	return prvMathFunction( pcWriteBuffer, xWriteBufferLen, pxArguments, fastmathSIN );
+}
+/*--------------------------------------------------------------------*/
+
+static int prvCommand_Cos( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
+{
+	( void ) xNumberOfArguments;
+
+	return prvMathFunction( pcWriteBuffer, xWriteBufferLen, pxArguments, fastmathCOS );
+}
+/*--------------------------------------------------------------------*/
+
+static int prvCommand_Atan2( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
+{
+	float fValues[appMATH_MAX_OPERANDS];
+	float fY[appMATH_MAX_OPERANDS / 2], fX[appMATH_MAX_OPERANDS / 2];
+	size_t uxCount, loop;
+
+	( void ) xNumberOfArguments;
+
+	if( prvParseOperands( pcWriteBuffer, xWriteBufferLen, pxArguments[0].pcString, fValues, &uxCount ) != pdPASS )
+		return pdFALSE;
+
+	if( ( uxCount % 2 ) != 0 )
+	{
+		snprintf( pcWriteBuffer, xWriteBufferLen, "Ingrese pares y x\r\n" );
+		return pdFALSE;
+	}
+
+	/* Split the pairs */
+	for( loop = 0 ; loop < uxCount / 2 ; loop++ )
+	{
+		fY[loop] = fValues[2 * loop];
+		fX[loop] = fValues[2 * loop + 1];
+	}
+
+	FastMath_Atan2Vector( xMathMode, fY, fX, fValues, uxCount / 2 );
+
+	prvPrintResults( pcWriteBuffer, xWriteBufferLen, fValues, uxCount / 2 );
 
 	return pdFALSE;
 }
 /*--------------------------------------------------------------------*/
 
-static int prvCommand_Multiplica( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static int prvCommand_Exp( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
 {
-	double xNum1, xNum2;
+	( void ) xNumberOfArguments;
 
-	/* validate and extract numbers entered with command */
-	if ( prvValidateExtractParammeters( pcWriteBuffer, xWriteBufferLen, pcCommandString, &xNum1, &xNum2 ) == pdFAIL )
-			return pdTRUE;
+	return prvMathFunction( pcWriteBuffer, xWriteBufferLen, pxArguments, fastmathEXP );
+}
+/*--------------------------------------------------------------------*/
 
-	/* format and print */
-	snprintf( pcWriteBuffer, xWriteBufferLen, "%g\r\n", xNum1 * xNum2 );
+static int prvCommand_Log( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
+{
+	( void ) xNumberOfArguments;
+
+	return prvMathFunction( pcWriteBuffer, xWriteBufferLen, pxArguments, fastmathLOG );
+}
+/*--------------------------------------------------------------------*/
+
+static int prvCommand_Modo( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
+{
+	( void ) xNumberOfArguments;
+
+	xMathMode = (FastMath_Mode_t)pxArguments[0].xKeyword;
+
+	snprintf( pcWriteBuffer, xWriteBufferLen, "modo: %s\r\n", pcMathModeNames[xMathMode] );
 
 	return pdFALSE;
 }
 /*--------------------------------------------------------------------*/
 
-static int prvCommand_Divide( char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString )
+static int prvCommand_Baud( char *pcWriteBuffer, size_t xWriteBufferLen, const CLI_Argument_t *pxArguments, int xNumberOfArguments )
 {
-	double xNum1, xNum2;
-	double xRes;
+	uint32_t ulPrevious = app_baudGetRate();
 
-	/* validate and extract numbers entered with command */
-	if ( prvValidateExtractParammeters( pcWriteBuffer, xWriteBufferLen, pcCommandString, &xNum1, &xNum2 ) == pdFAIL )
-			return pdTRUE;
+	( void ) xNumberOfArguments;
 
-	/* If denominator is zero, then error */
-	if(xNum2 == 0)
-		snprintf( pcWriteBuffer, xWriteBufferLen, "ERROR\r\n");
-	else
+	if( !app_baudRequest( (uint32_t)pxArguments[0].lInteger ) )
 	{
-		/* format and print */
-		snprintf( pcWriteBuffer, xWriteBufferLen, "%g\r\n", xNum1 / xNum2 );
+		snprintf( pcWriteBuffer, xWriteBufferLen, "baud: negociación en curso\r\n" );
+		return pdFALSE;
 	}
 
+	/* Last answer at the previous rate */
+	snprintf( pcWriteBuffer, xWriteBufferLen, "baud: %lu -> %lu, confirmar con \"%s\"\r\n",
+			(unsigned long)ulPrevious, (unsigned long)pxArguments[0].lInteger, baudCONFIRMATION );
+
 	return pdFALSE;
 }
-
+
 
 /*=====[Public functions implementation]===================================*/
 
@@ -312,4 +1167,17 @@ void app_commandRegisterCLICommands( void )
 	CLI_RegisterCommand( &sRestaCommand );
 	CLI_RegisterCommand( &sMultiplicaCommand );
 	CLI_RegisterCommand( &sDivideCommand );
+	CLI_RegisterCommand( &sBenchCommand );
+	CLI_RegisterCommand( &sMotorCommand );
+	CLI_RegisterCommand( &sStreamCommand );
+	CLI_RegisterCommand( &sSummaryCommand );
+	CLI_RegisterCommand( &sTraceCommand );
+	CLI_RegisterCommand( &sSqrtCommand );
+	CLI_RegisterCommand( &sSinCommand );
+	CLI_RegisterCommand( &sCosCommand );
+	CLI_RegisterCommand( &sAtan2Command );
+	CLI_RegisterCommand( &sExpCommand );
+	CLI_RegisterCommand( &sLogCommand );
+	CLI_RegisterCommand( &sModoCommand );
+	CLI_RegisterCommand( &sBaudCommand );
 }
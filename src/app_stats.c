@@ -0,0 +1,254 @@
+/*
+ * app_stats.c
+ *
+ *  Running statistics of a stream of samples, with constant memory.
+ *  Mean and variance are updated with Welford's algorithm, and quantiles
+ *  are estimated with the P-square algorithm (Jain & Chlamtac), 5 markers each.
+ */
+
+/*=====[Includes]===========================================================*/
+
+#include "app_stats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+/*=====[Definitions and macros]=============================================*/
+
+#define statsMARKERS		5			/**< Markers of the P-square algorithm */
+
+
+/*=====[Definitions of private data types]==================================*/
+
+/**
+ * Markers of the P-square algorithm for one quantile.
+ */
+typedef struct
+{
+	double dHeight[statsMARKERS];		/**< Height of each marker, the quantile is the middle one */
+	double dPosition[statsMARKERS];		/**< Actual position of each marker */
+	double dDesired[statsMARKERS];		/**< Desired position of each marker */
+	double dIncrement[statsMARKERS];	/**< Increment of desired position for each sample */
+} prvQuantile_t;
+
+
+/*=====[Private functions declarations]=====================================*/
+
+/*
+ * Initialize the markers of a quantile with the first statsMARKERS samples, already sorted.
+ * @param	pxQuantile		markers to initialize.
+ * @param	dProbability	probability of the quantile.
+ */
+static void prvQuantileInit( prvQuantile_t *pxQuantile, double dProbability );
+
+/*
+ * Update the markers of a quantile with a new sample.
+ * @param	pxQuantile		markers to update.
+ * @param	dSample			new sample.
+ */
+static void prvQuantileUpdate( prvQuantile_t *pxQuantile, double dSample );
+
+
+/*=====[Private global variables definition]=====================================*/
+
+static const double dProbabilities[statsQUANTILES] = { 0.5, 0.9, 0.99 };
+
+static uint32_t ulCount = 0;						/**< Samples absorbed */
+static uint32_t ulRejected = 0;						/**< Lines that were not a number */
+static double dMean = 0;							/**< Running mean */
+static double dM2 = 0;								/**< Sum of squares of differences from the mean */
+static double dMin = 0;								/**< Minimum sample */
+static double dMax = 0;								/**< Maximum sample */
+static double dFirst[statsMARKERS];					/**< First samples, sorted, until markers are initialized */
+static prvQuantile_t xQuantiles[statsQUANTILES];	/**< Markers of each quantile */
+static volatile bool bStreamMode = false;			/**< Stream mode active */
+
+
+/*=====[Private functions implementation]===================================*/
+
+static void prvQuantileInit( prvQuantile_t *pxQuantile, double dProbability )
+{
+	int loop;
+
+	for( loop = 0 ; loop < statsMARKERS ; loop++ )
+	{
+		pxQuantile->dHeight[loop] = dFirst[loop];
+		pxQuantile->dPosition[loop] = loop + 1;
+	}
+
+	pxQuantile->dDesired[0] = 1;
+	pxQuantile->dDesired[1] = 1 + 2 * dProbability;
+	pxQuantile->dDesired[2] = 1 + 4 * dProbability;
+	pxQuantile->dDesired[3] = 3 + 2 * dProbability;
+	pxQuantile->dDesired[4] = 5;
+
+	pxQuantile->dIncrement[0] = 0;
+	pxQuantile->dIncrement[1] = dProbability / 2;
+	pxQuantile->dIncrement[2] = dProbability;
+	pxQuantile->dIncrement[3] = ( 1 + dProbability ) / 2;
+	pxQuantile->dIncrement[4] = 1;
+}
+/*--------------------------------------------------------------------*/
+
+static void prvQuantileUpdate( prvQuantile_t *pxQuantile, double dSample )
+{
+	double *q = pxQuantile->dHeight, *n = pxQuantile->dPosition;
+	double dDelta, dParabolic;
+	int loop, xCell, xSign;
+
+	/* Find the cell of the sample, extending the extremes if needed */
+	if( dSample < q[0] )
+	{
+		q[0] = dSample;
+		xCell = 0;
+	}
+	else if( dSample >= q[4] )
+	{
+		q[4] = dSample;
+		xCell = 3;
+	}
+	else
+	{
+		for( xCell = 0 ; xCell < 3 ; xCell++ )
+		{
+			if( dSample < q[xCell + 1] )
+				break;
+		}
+	}
+
+	for( loop = xCell + 1 ; loop < statsMARKERS ; loop++ )
+		n[loop]++;
+	for( loop = 0 ; loop < statsMARKERS ; loop++ )
+		pxQuantile->dDesired[loop] += pxQuantile->dIncrement[loop];
+
+	/* Adjust middle markers that are out of their desired position */
+	for( loop = 1 ; loop < statsMARKERS - 1 ; loop++ )
+	{
+		dDelta = pxQuantile->dDesired[loop] - n[loop];
+
+		if( ( ( dDelta >= 1 ) && ( n[loop + 1] - n[loop] > 1 ) ) ||
+			( ( dDelta <= -1 ) && ( n[loop - 1] - n[loop] < -1 ) ) )
+		{
+			xSign = ( dDelta > 0 ) ? 1 : -1;
+
+			/* Piecewise parabolic prediction, or linear if it is not monotonic */
+			dParabolic = q[loop] + xSign / ( n[loop + 1] - n[loop - 1] ) *
+						( ( n[loop] - n[loop - 1] + xSign ) * ( q[loop + 1] - q[loop] ) / ( n[loop + 1] - n[loop] ) +
+						  ( n[loop + 1] - n[loop] - xSign ) * ( q[loop] - q[loop - 1] ) / ( n[loop] - n[loop - 1] ) );
+
+			if( ( q[loop - 1] < dParabolic ) && ( dParabolic < q[loop + 1] ) )
+				q[loop] = dParabolic;
+			else
+				q[loop] += xSign * ( q[loop + xSign] - q[loop] ) / ( n[loop + xSign] - n[loop] );
+
+			n[loop] += xSign;
+		}
+	}
+}
+
+
+/*=====[Public functions implementation]===================================*/
+
+void app_statsReset( void )
+{
+	ulCount = 0;
+	ulRejected = 0;
+	dMean = 0;
+	dM2 = 0;
+	dMin = 0;
+	dMax = 0;
+}
+/*-----------------------------------------------------------*/
+
+void app_statsPush( double dSample )
+{
+	double dDelta;
+	int loop;
+
+	/* Welford's algorithm */
+	ulCount++;
+	dDelta = dSample - dMean;
+	dMean += dDelta / ulCount;
+	dM2 += dDelta * ( dSample - dMean );
+
+	if( ( ulCount == 1 ) || ( dSample < dMin ) )
+		dMin = dSample;
+	if( ( ulCount == 1 ) || ( dSample > dMax ) )
+		dMax = dSample;
+
+	if( ulCount <= statsMARKERS )
+	{
+		/* Keep first samples sorted, by insertion */
+		for( loop = ulCount - 1 ; ( loop > 0 ) && ( dFirst[loop - 1] > dSample ) ; loop-- )
+			dFirst[loop] = dFirst[loop - 1];
+		dFirst[loop] = dSample;
+
+		if( ulCount == statsMARKERS )
+		{
+			for( loop = 0 ; loop < statsQUANTILES ; loop++ )
+				prvQuantileInit( &xQuantiles[loop], dProbabilities[loop] );
+		}
+	}
+	else
+	{
+		for( loop = 0 ; loop < statsQUANTILES ; loop++ )
+			prvQuantileUpdate( &xQuantiles[loop], dSample );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void app_statsPushString( const char *pcSample )
+{
+	char *pcEnd;
+	double dSample;
+
+	/* Empty lines are ignored */
+	if( *pcSample == '\0' )
+		return;
+
+	dSample = strtod( pcSample, &pcEnd );
+
+	if( ( pcEnd == pcSample ) || ( *pcEnd != '\0' ) || !isfinite( dSample ) )
+		ulRejected++;
+	else
+		app_statsPush( dSample );
+}
+/*-----------------------------------------------------------*/
+
+void app_statsGetSummary( Stats_Summary_t *pxSummary )
+{
+	int loop;
+
+	pxSummary->ulCount = ulCount;
+	pxSummary->ulRejected = ulRejected;
+	pxSummary->dMean = dMean;
+	pxSummary->dVariance = ( ulCount > 1 ) ? dM2 / ( ulCount - 1 ) : 0;
+	pxSummary->dMin = dMin;
+	pxSummary->dMax = dMax;
+
+	for( loop = 0 ; loop < statsQUANTILES ; loop++ )
+	{
+		pxSummary->dQuantileProbability[loop] = dProbabilities[loop];
+
+		if( ulCount >= statsMARKERS )
+			pxSummary->dQuantile[loop] = xQuantiles[loop].dHeight[2];
+		else if( ulCount > 0 )
+			/* Few samples: nearest rank on the sorted samples */
+			pxSummary->dQuantile[loop] = dFirst[(int)( dProbabilities[loop] * ( ulCount - 1 ) + 0.5 )];
+		else
+			pxSummary->dQuantile[loop] = 0;
+	}
+}
+/*-----------------------------------------------------------*/
+
+void app_statsSetStreaming( bool bStreaming )
+{
+	bStreamMode = bStreaming;
+}
+/*-----------------------------------------------------------*/
+
+bool app_statsIsStreaming( void )
+{
+	return bStreamMode;
+}
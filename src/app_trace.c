@@ -0,0 +1,74 @@
+/*
+ * app_trace.c
+ *
+ *  Binary trace of timestamped events on a fixed size ring.
+ */
+
+/*=====[Includes]===========================================================*/
+
+#include "app_trace.h"
+#include "CLI.h"
+#include "sapi.h"
+
+
+/*=====[Public global variables definition]=====================================*/
+
+Trace_Record_t xTraceBuffer[traceBUFFER_SIZE];
+uint32_t ulTraceHead = 0;
+volatile bool bTracePaused = false;
+
+
+/*=====[Public functions implementation]===================================*/
+
+void app_traceInit( void )
+{
+	/* Timestamps are read directly from DWT cycle counter */
+	cyclesCounterInit( SystemCoreClock );
+	app_traceClear();
+}
+/*-----------------------------------------------------------*/
+
+void app_traceClear( void )
+{
+	__atomic_store_n( &ulTraceHead, 0, __ATOMIC_RELAXED );
+}
+/*-----------------------------------------------------------*/
+
+void app_tracePause( bool bPause )
+{
+	bTracePaused = bPause;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t app_traceCount( void )
+{
+	uint32_t ulHead = __atomic_load_n( &ulTraceHead, __ATOMIC_RELAXED );
+
+	return ( ulHead < traceBUFFER_SIZE ) ? ulHead : traceBUFFER_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+const Trace_Record_t* app_traceGet( uint32_t ulIndex )
+{
+	uint32_t ulHead = __atomic_load_n( &ulTraceHead, __ATOMIC_RELAXED );
+
+	/* The oldest record is the one after the last written */
+	return &xTraceBuffer[( ulHead - app_traceCount() + ulIndex ) & ( traceBUFFER_SIZE - 1 )];
+}
+/*-----------------------------------------------------------*/
+
+/* Hooks of the CLI library, called when it is built with cliTRACE_HOOKS */
+void CLI_TraceCommandStart( int xCommandIndex )
+{
+	( void ) xCommandIndex;
+
+	traceRECORD( traceEV_CMD_START, xCommandIndex );
+}
+/*-----------------------------------------------------------*/
+
+void CLI_TraceCommandEnd( int xReturn )
+{
+	( void ) xReturn;
+
+	traceRECORD( traceEV_CMD_END, xReturn );
+}
@@ -19,16 +19,48 @@
 #include "ring_buffer.h"	/**< lpcOpen ring buffer implementation*/
 #include "CLI.h"			/**< CLI implementation*/
 #include "app_commands.h"	/**< commands created to process with CLI */
+#include "app_stats.h"		/**< running statistics of stream mode */
+#include "app_trace.h"		/**< binary trace of events */
+#include "app_baud.h"		/**< baud rate negotiation */
 
 
 /*=====[Definitions and macros]=============================================*/
 
-#define uartBUFFER_SIZE	16					/**< Size of ring buffer uart.*/
-											/**< Must be power of 2 and at least 2 (see ring_buffer.h for more detail) */
+/* Buffer sizes can be overridden from config.mk (DEFINES+=uartBUFFER_SIZE=32)
+to measure them with tools/loadgen.py */
+/* rbRxBuffer holds the bytes that arrive while the main loop is busy: the
+longest stall is one slice of "bench" (10ms), 115 bytes at 115200. It holds
+them only if clients keep at most appPIPELINE_DEPTH lines without answer.
+Bytes that do not fit are counted on ulRxOverruns, and the line they belong
+to is answered with an error instead of being run incomplete */
+#ifndef uartBUFFER_SIZE
+	#define uartBUFFER_SIZE	256				/**< Size of ring buffer uart.*/
+#endif										/**< Must be power of 2 and at least 2 (see ring_buffer.h for more detail) */
 
-#define appIN_BUFFER_SIZE	64				/**< Size of input buffer */
-#define appOUT_BUFFER_SIZE	256				/**< Size of output buffer */
+/* A line holds a tag, "bench <n>" and an arithmetic command with two operands
+of cliMAX_NUMBER_LENGTH characters: "#1234567890 bench 100000 multiplica a b" */
+#ifndef appIN_BUFFER_SIZE
+	#define appIN_BUFFER_SIZE	208			/**< Size of input buffer */
+#endif
+#ifndef appOUT_BUFFER_SIZE
+	#define appOUT_BUFFER_SIZE	256			/**< Size of output buffer */
+#endif
 
+/* RX FIFO of the LPC4337 UART is 16 bytes. The interrupt is raised when
+uartRX_TRIGGER bytes are waiting, or after ~4 character times without new
+bytes (character timeout), so the tail of a burst is not left on the FIFO */
+#define uartFIFO_SIZE		16
+#define uartUSB_LPC			LPC_USART2		/**< Peripheral of UART_USB on the EDU-CIAA (lpcUarts table of sAPI, not exported) */
+#ifndef uartRX_TRIGGER
+	#define uartRX_TRIGGER	UART_FCR_TRG_LEV2		/**< 8 bytes. LEV0: 1, LEV1: 4, LEV3: 14 */
+#endif
+
+/* Commands in flight at the same time, each one on its own session */
+#ifndef appPIPELINE_DEPTH
+	#define appPIPELINE_DEPTH	4
+#endif
+#define appTAG_SIZE			10				/**< Max digits of the tag of a command: "#42 suma 1 2" */
+
 #define ETX    0x03     					/**< ASCII end of text */
 
 /* keep alive leds */
@@ -43,24 +75,72 @@ typedef enum{
 	PROCESSING,
 }stateUART_t;
 
+/** A command line in flight */
+typedef struct{
+	char cCommand[appIN_BUFFER_SIZE];	/**< Command line, without the tag */
+	char cTag[appTAG_SIZE + 3];			/**< "#42 ", empty if the line has no tag */
+	uint32_t ulSequence;				/**< Order of arrival */
+	bool bActive;						/**< Waiting or running */
+	bool bStarted;						/**< Called at least once */
+	bool bCancel;						/**< ETX received after it */
+	bool bLineStart;					/**< Next byte written starts a line of the answer */
+}appSession_t;
+
 
 /*=====[Variables]=========================================================*/
 
 RINGBUFF_T rbRxBuffer;
 char cRxBuffer[uartBUFFER_SIZE] = {0};
+appSession_t xSessions[appPIPELINE_DEPTH];
+
+volatile uint32_t ulRxOverruns = 0;			/**< Bytes lost because rbRxBuffer was full */
+volatile uint32_t ulRxInserted = 0;			/**< Bytes inserted on rbRxBuffer since reset */
+volatile uint32_t ulRxLostAt = 0;			/**< Value of ulRxInserted when bytes were lost */
+volatile bool bRxLost = false;				/**< ulRxLostAt not yet reached by app_Receive */
+uint32_t ulRxRateChangeAt = 0;				/**< Value of ulRxInserted when the baud rate changed */
+bool bRxRateChange = false;					/**< ulRxRateChangeAt not yet reached by app_Receive */
 
 
 /*=====[Callback functions]================================================*/
 
-/** Data UART_USB reception */
+/** Data UART_USB reception.
+ * Called on RX trigger level and on character timeout: drain every byte
+ * waiting on the hardware FIFO and insert them all at once. */
 void UART_USBOnRx( void *noUsado )
 {
-   char c = uartRxRead( UART_USB );
-   if(c == ETX)
+   char cBurst[uartFIFO_SIZE];
+   int xBurstLength = 0;
+   int xInserted;
+
+   while( uartRxReady( UART_USB ) && ( xBurstLength < uartFIFO_SIZE ) )
    {
-	  /* Implement a forced exit */
+	  cBurst[xBurstLength] = uartRxRead( UART_USB );
+	  traceRECORD( traceEV_RX, cBurst[xBurstLength] );
+	  if( cBurst[xBurstLength] == ETX )
+	  {
+		 /* Forced exit: the running command stops on its next yield */
+		 CLI_RequestCancel();
+	  }
+	  xBurstLength++;
+   }
+
+   xInserted = RingBuffer_InsertMult( &rbRxBuffer, cBurst, xBurstLength );
+   ulRxInserted += xInserted;
+   if( xInserted < xBurstLength )
+   {
+	  /* Mark where the bytes are missing, app_Receive discards that line */
+	  if( !bRxLost )
+	  {
+		 ulRxLostAt = ulRxInserted;
+		 bRxLost = true;
+	  }
+	  ulRxOverruns += xBurstLength - xInserted;
+   }
+   while( xInserted < xBurstLength )
+   {
+	  traceRECORD( traceEV_OVERRUN, cBurst[xInserted] );
+	  xInserted++;
    }
-   RingBuffer_Insert( &rbRxBuffer, &c );
 }
 
 
@@ -73,10 +153,29 @@ void app_ToggleLED()
 }
 /*-----------------------------------------------------------*/
 
-void UART_USBConfig()
+void UART_USBConfig( uint32_t ulBaudRate )
 {
+	static uint32_t ulCurrentRate = 0;
+	uint32_t ulStart;
+
+	/* Changing the rate: let the answer already written leave at the old rate.
+	TX FIFO empty, then two characters more for the shift register */
+	if( ulCurrentRate != 0 )
+	{
+		while( !uartTxReady( UART_USB ) );
+		ulStart = cyclesCounterRead();
+		while( cyclesCounterRead() - ulStart < ( SystemCoreClock / ulCurrentRate ) * 20 );
+
+		/* Bytes already received were sent at the old rate */
+		ulRxRateChangeAt = ulRxInserted;
+		bRxRateChange = true;
+	}
+	ulCurrentRate = ulBaudRate;
+
 	/* Initialize UART_USB and interrupts */
-    uartConfig(UART_USB, 115200);
+    uartConfig(UART_USB, ulBaudRate);
+    /* Raise RX trigger level, one interrupt per burst instead of per byte */
+    Chip_UART_SetupFIFOS(uartUSB_LPC, UART_FCR_FIFO_EN | uartRX_TRIGGER);
     /* Define callback and event interrupt */
     uartCallbackSet(UART_USB, UART_RECEIVE, UART_USBOnRx, NULL);
     /* enable UART_USB interrupts */
@@ -84,81 +183,505 @@ void UART_USBConfig()
 }
 /*-----------------------------------------------------------*/
 
+void UART_USBWriteString( const char *pcString )
+{
+	size_t uxLength = strlen( pcString );
+
+	/* Nothing to write, do not fill the trace with empty writes */
+	if( uxLength == 0 )
+		return;
+
+	traceRECORD( traceEV_TX_START, uxLength );
+	uartWriteString( UART_USB, pcString );
+	traceRECORD( traceEV_TX_END, uxLength );
+}
+/*-----------------------------------------------------------*/
+
 void app_FMS_Init()
 {
 	RingBuffer_Init( &rbRxBuffer, &cRxBuffer, sizeof( char ), sizeof( cRxBuffer ) );
+	memset( xSessions, 0, sizeof( xSessions ) );
+}
+/*-----------------------------------------------------------*/
+
+/** Mark every command in flight as cancelled */
+void app_SessionCancelAll()
+{
+	int loop;
+
+	for( loop = 0 ; loop < appPIPELINE_DEPTH ; loop++ )
+	{
+		if( xSessions[loop].bActive )
+			xSessions[loop].bCancel = true;
+	}
+}
+/*-----------------------------------------------------------*/
+
+/** Length of the valid tag that starts a line, "#42 ", 0 if it has none */
+size_t app_LineTagLength( const char *pcLine )
+{
+	size_t uxTagLength = 0;
+
+	if( pcLine[0] == '#' )
+		uxTagLength = strspn( pcLine + 1, "0123456789" );
+
+	if( ( uxTagLength == 0 ) || ( uxTagLength > appTAG_SIZE ) || ( pcLine[uxTagLength + 1] != ' ' ) )
+		return 0;
+
+	return uxTagLength + 2;
+}
+/*-----------------------------------------------------------*/
+
+/** Take a free session for a new command line. Return false if it has to wait */
+bool app_SessionStart( const char *pcLine )
+{
+	static uint32_t ulSequence = 0;
+	appSession_t *pxSession = NULL;
+	size_t uxTagLength;
+	int loop;
+
+	for( loop = 0 ; loop < appPIPELINE_DEPTH ; loop++ )
+	{
+		/* An untagged command is answered before the next line is taken, as without pipeline */
+		if( xSessions[loop].bActive && ( xSessions[loop].cTag[0] == '\0' ) )
+			return false;
+		if( !xSessions[loop].bActive && ( pxSession == NULL ) )
+			pxSession = &xSessions[loop];
+	}
+	if( pxSession == NULL )
+		return false;
+
+	memset( pxSession, 0, sizeof( appSession_t ) );
+
+	/* Optional tag: "#42 suma 1 2" */
+	if( pcLine[0] == '#' )
+	{
+		uxTagLength = app_LineTagLength( pcLine );
+		if( uxTagLength == 0 )
+		{
+			UART_USBWriteString( "Etiqueta no válida\r\n" );
+			return true;
+		}
+		/* The tag and one space start each line of the answer */
+		memcpy( pxSession->cTag, pcLine, uxTagLength );
+		pcLine += uxTagLength + strspn( pcLine + uxTagLength, " " );
+	}
+
+	strcpy( pxSession->cCommand, pcLine );
+	pxSession->ulSequence = ulSequence++;
+	pxSession->bLineStart = true;
+	pxSession->bActive = true;
+
+	return true;
+}
+/*-----------------------------------------------------------*/
+
+/** Load the names of the commands a line calls: its own, and for "bench"
+ * also the one it measures. Return how many */
+int app_CommandNames( const char *pcCommand, const char *pcNames[2], size_t uxLengths[2] )
+{
+	size_t uxLength = strcspn( pcCommand, " " );
+
+	pcNames[0] = pcCommand;
+	uxLengths[0] = uxLength;
+
+	if( ( uxLength != 5 ) || ( strncmp( pcCommand, "bench", 5 ) != 0 ) )
+		return 1;
+
+	/* "bench <n> <command line>" */
+	pcCommand += uxLength;
+	pcCommand += strspn( pcCommand, " " );
+	pcCommand += strcspn( pcCommand, " " );
+	pcCommand += strspn( pcCommand, " " );
+	pcNames[1] = pcCommand;
+	uxLengths[1] = strcspn( pcCommand, " " );
+
+	return 2;
+}
+/*-----------------------------------------------------------*/
+
+/** Return true if two command lines call some command in common */
+bool app_CommandsShareName( const char *pcCommandA, const char *pcCommandB )
+{
+	const char *pcNamesA[2], *pcNamesB[2];
+	size_t uxLengthsA[2], uxLengthsB[2];
+	int xNamesA, xNamesB, loopA, loopB;
+
+	xNamesA = app_CommandNames( pcCommandA, pcNamesA, uxLengthsA );
+	xNamesB = app_CommandNames( pcCommandB, pcNamesB, uxLengthsB );
+
+	for( loopA = 0 ; loopA < xNamesA ; loopA++ )
+	{
+		for( loopB = 0 ; loopB < xNamesB ; loopB++ )
+		{
+			if( ( uxLengthsA[loopA] == uxLengthsB[loopB] ) &&
+				( strncmp( pcNamesA[loopA], pcNamesB[loopB], uxLengthsA[loopA] ) == 0 ) )
+				return true;
+		}
+	}
+
+	return false;
+}
+/*-----------------------------------------------------------*/
+
+/** Return true if the command line changes how the commands after it run:
+ * "motor", "modo", "stream" and "baud", also measured by "bench" */
+bool app_CommandChangesState( const char *pcCommand )
+{
+	static const char * const pcStateCommands[] = { "motor", "modo", "stream", "baud" };
+	const char *pcNames[2];
+	size_t uxLengths[2];
+	int xNames, loop, xCommand;
+
+	xNames = app_CommandNames( pcCommand, pcNames, uxLengths );
+
+	for( loop = 0 ; loop < xNames ; loop++ )
+	{
+		for( xCommand = 0 ; xCommand < (int)( sizeof( pcStateCommands ) / sizeof( pcStateCommands[0] ) ) ; xCommand++ )
+		{
+			if( ( uxLengths[loop] == strlen( pcStateCommands[xCommand] ) ) &&
+				( strncmp( pcNames[loop], pcStateCommands[xCommand], uxLengths[loop] ) == 0 ) )
+				return true;
+		}
+	}
+
+	return false;
+}
+/*-----------------------------------------------------------*/
+
+/** Return true if the session can be called now.
+ * An untagged command, or one that changes state, waits for every command
+ * received before it, and the ones received after it wait for it, the same
+ * as without pipeline. So "#1 motor decimal" runs before "#2 multiplica 2 3".
+ * Commands that yield keep their state on static variables, so two sessions
+ * that call the same command run one after the other. "bench" calls the
+ * command it measures, so "bench 10 trace dump" waits for "trace dump" */
+bool app_SessionRunnable( const appSession_t *pxSession )
+{
+	const appSession_t *pxOther;
+	int loop;
+
+	for( loop = 0 ; loop < appPIPELINE_DEPTH ; loop++ )
+	{
+		pxOther = &xSessions[loop];
+		if( !pxOther->bActive || ( pxOther->ulSequence >= pxSession->ulSequence ) )
+			continue;
+
+		if( ( pxSession->cTag[0] == '\0' ) || ( pxOther->cTag[0] == '\0' ) )
+			return false;
+
+		if( app_CommandChangesState( pxSession->cCommand ) || app_CommandChangesState( pxOther->cCommand ) )
+			return false;
+
+		if( app_CommandsShareName( pxOther->cCommand, pxSession->cCommand ) )
+			return false;
+	}
+
+	return true;
+}
+/*-----------------------------------------------------------*/
+
+/** Next session to call, taking turns among the ones that can run. NULL if none */
+appSession_t* app_SessionNext()
+{
+	static int xLast = 0;
+	int loop, xIndex;
+
+	/* The commands received with "baud" answer once both ends use the same rate */
+	if( app_baudIsPending() )
+		return NULL;
+
+	for( loop = 1 ; loop <= appPIPELINE_DEPTH ; loop++ )
+	{
+		xIndex = ( xLast + loop ) % appPIPELINE_DEPTH;
+		if( xSessions[xIndex].bActive && app_SessionRunnable( &xSessions[xIndex] ) )
+		{
+			xLast = xIndex;
+			return &xSessions[xIndex];
+		}
+	}
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+/** Write the answer of a session. With a tag, the tag starts every line, so
+ * the client matches the lines of commands that run at the same time.
+ * Commands write whole lines on each call, so lines of different commands do not mix */
+void app_SessionWrite( appSession_t *pxSession, char *pcString )
+{
+	char *pcLineEnd;
+	char cNext;
+
+	if( pxSession->cTag[0] == '\0' )
+	{
+		UART_USBWriteString( pcString );
+		return;
+	}
+
+	while( *pcString != '\0' )
+	{
+		if( pxSession->bLineStart )
+		{
+			UART_USBWriteString( pxSession->cTag );
+			pxSession->bLineStart = false;
+		}
+
+		pcLineEnd = strchr( pcString, '\n' );
+		if( pcLineEnd == NULL )
+		{
+			UART_USBWriteString( pcString );
+			return;
+		}
+
+		/* Write up to the end of line */
+		pcLineEnd++;
+		cNext = *pcLineEnd;
+		*pcLineEnd = '\0';
+		UART_USBWriteString( pcString );
+		*pcLineEnd = cNext;
+
+		pcString = pcLineEnd;
+		pxSession->bLineStart = true;
+	}
+}
+/*-----------------------------------------------------------*/
+
+/** Call once the command of a session. If it yield, it is called again on its next turn */
+void app_SessionRun( appSession_t *pxSession, char *pcOutputBuffer )
+{
+	int xCancelled = pxSession->bCancel;
+	int xReturn;
+
+	if( !pxSession->bStarted )
+	{
+		/* Cancelled before its first call: it is not run */
+		if( xCancelled )
+		{
+			strcpy( pcOutputBuffer, "Cancelado\r\n" );
+			app_SessionWrite( pxSession, pcOutputBuffer );
+			pxSession->bActive = false;
+			return;
+		}
+		/* Lines received after "stream" are samples, the tag was already removed */
+		if( app_statsIsStreaming() )
+		{
+			app_statsPushString( pxSession->cCommand );
+			pxSession->bActive = false;
+			return;
+		}
+		pxSession->bStarted = true;
+	}
+
+	/* If cancelled, the command see the request on this last call. The ETX
+	that may arrive meanwhile is left requested for app_FSM */
+	if( xCancelled )
+		xReturn = CLI_CancelCommand( pxSession->cCommand, pcOutputBuffer, appOUT_BUFFER_SIZE );
+	else
+		xReturn = CLI_ProcessCommand( pxSession->cCommand, pcOutputBuffer, appOUT_BUFFER_SIZE );
+
+	if( ( xReturn != pdTRUE ) || xCancelled )
+		pxSession->bActive = false;
+
+	/* Also when the command saw the ETX before app_FSM marked the session */
+	app_SessionWrite( pxSession, pcOutputBuffer );
+	if( xCancelled || ( xReturn == cliCANCELLED ) )
+	{
+		strcpy( pcOutputBuffer, "Cancelado\r\n" );
+		app_SessionWrite( pxSession, pcOutputBuffer );
+	}
+}
+/*-----------------------------------------------------------*/
+
+/** Answer a line that is not run, with its tag if it has a valid one */
+void app_LineReject( const char *pcLine, const char *pcMessage )
+{
+	char cTag[appTAG_SIZE + 3];
+	size_t uxTagLength = app_LineTagLength( pcLine );
+
+	if( uxTagLength > 0 )
+	{
+		memcpy( cTag, pcLine, uxTagLength );
+		cTag[uxTagLength] = '\0';
+		UART_USBWriteString( cTag );
+	}
+	UART_USBWriteString( pcMessage );
+}
+/*-----------------------------------------------------------*/
+
+/** Deliver a line received: confirmation of a new baud rate, sample of stream
+ * mode or command. Return false if it has to wait a free session */
+bool app_LineReceived( const char *pcLine )
+{
+	/* Lines received before the change of rate are commands, they run once the rate is agreed */
+	if( app_baudIsConfirming() && !bRxRateChange )
+	{
+		/* Only the confirmation is valid at the new rate. Other lines are
+		answered, so no tag is left waiting. Empty lines end the noise of the
+		change, they are not answered */
+		if( app_baudConfirm( pcLine ) )
+			UART_USBWriteString( "baud: confirmado\r\n" );
+		else if( pcLine[0] != '\0' )
+			app_LineReject( pcLine, "baud: esperando confirmación, línea descartada\r\n" );
+		return true;
+	}
+
+	if( app_statsIsStreaming() )
+	{
+		/* On stream mode each line is a sample, it is absorbed without processing a command nor answering.
+		A valid tag is removed, as from the lines that waited on a session when "stream" started */
+		app_statsPushString( pcLine + app_LineTagLength( pcLine ) );
+		return true;
+	}
+
+	return app_SessionStart( pcLine );
+}
+/*-----------------------------------------------------------*/
+
+/** Take the bytes received and store them on the line being received. Each
+ * line completed goes to a free session. Return true while a line is half received */
+bool app_Receive()
+{
+	static char cLine[appIN_BUFFER_SIZE] = {0};		/**< Buffer to store input data */
+	static int xItem = 0;
+	static bool bLineReady = false;						/**< Line complete, waiting a free session */
+	static bool bLineLost = false;						/**< Bytes of the line were lost, discard it */
+	static uint32_t ulPopped = 0;						/**< Bytes taken from rbRxBuffer since reset */
+	char cRx;
+
+	/* All sessions were busy: the next bytes wait on rbRxBuffer until the line has a session */
+	if( bLineReady )
+	{
+		if( !app_LineReceived( cLine ) )
+			return true;
+		memset( cLine, 0, xItem );
+		xItem = 0;
+		bLineReady = false;
+	}
+
+	for( ;; )
+	{
+		/* Every byte before the ones lost was taken: the line being received is
+		incomplete. Answer it now, and skip what arrives of it after the bytes lost */
+		if( bRxLost && ( ulPopped == ulRxLostAt ) )
+		{
+			bRxLost = false;
+			app_LineReject( cLine, "Desborde de recepción, línea descartada\r\n" );
+			memset( cLine, 0, xItem );
+			xItem = 0;
+			bLineLost = true;
+		}
+
+		/* The line cut by a change of rate has bytes of both rates, discard it */
+		if( bRxRateChange && ( ulPopped == ulRxRateChangeAt ) )
+		{
+			bRxRateChange = false;
+			memset( cLine, 0, xItem );
+			xItem = 0;
+		}
+
+		if( RingBuffer_Pop( &rbRxBuffer, &cRx ) != 1 )
+			break;
+		ulPopped++;
+
+		/* store input data on buffer until new line arrive, then start a session to process it */
+		if( cRx == ETX )
+		{
+			/* ETX cancel the commands received before it, and leave stream mode */
+			app_SessionCancelAll();
+			app_statsSetStreaming( false );
+			memset( cLine, 0, appIN_BUFFER_SIZE );
+			xItem = 0;
+			bLineLost = false;
+		}
+		else if( bLineLost )
+		{
+			if( cRx == '\n' )
+				bLineLost = false;
+		}
+		else if( ( cRx == '\b' ) && ( xItem > 0 ) )
+		{
+			cLine[--xItem] = '\0';
+		}
+		else if( cRx == '\n' )
+		{
+			if( !app_LineReceived( cLine ) )
+			{
+				bLineReady = true;
+				return true;
+			}
+			memset( cLine, 0, xItem );
+			xItem = 0;
+		}
+		else if ( isprint(cRx) != 0 && ( xItem < appIN_BUFFER_SIZE - 1 ) )
+			cLine[xItem++] = cRx;
+	}
+
+	return ( xItem > 0 );
 }
 /*-----------------------------------------------------------*/
 
 void app_FSM()
 {
 	static stateUART_t xState_UART = IDLE;				/**< State to handle state machine */
-	static char cCommand[appIN_BUFFER_SIZE] = {0};		/**< Buffer to store input data */
-	static int xItem = 0;
 
-	char cRx;
 	char cOutputBuffer[appOUT_BUFFER_SIZE] = {0};		/**< Buffer to store data to print */
+	stateUART_t xPreviousState = xState_UART;
+	appSession_t *pxSession;
+	const char *pcBaudMessage;
+	bool bReceiving;
+
+	/* ETX received on the interrupt: the commands in flight stop on their next call */
+	if( CLI_IsCancelRequested() )
+	{
+		app_SessionCancelAll();
+		CLI_ClearCancel();
+	}
+
+	/* Lines keep arriving while commands run, so a client can send many of them without waiting */
+	bReceiving = app_Receive();
+	pxSession = app_SessionNext();
 
 	switch(xState_UART)
 	{
 		case IDLE:
-			/* if there is something in uart, then go to receiving */
-			if( RingBuffer_GetCount( &rbRxBuffer) > 0 )
-				xState_UART = RECEIVING;
-			break;
 		case RECEIVING:
-			if( RingBuffer_Pop( &rbRxBuffer, &cRx ) == 1)
-			{
-				/* store input data on buffer until new line arrive, then jump to process data */
-            if( cRx == ETX)
-            {
-               memset( cCommand, 0, appIN_BUFFER_SIZE );
-               memset( cOutputBuffer, 0, appOUT_BUFFER_SIZE );
-               xItem = 0;
-               xState_UART = IDLE;
-            }
-            else if ( ( cRx == '\b' ) && ( xItem > 0 ) )
-            {
-               cCommand[--xItem] = '\0';   
-            }
-				else if( cRx == '\n' )
-					xState_UART = PROCESSING;
-				else if ( isprint(cRx) != 0 && ( xItem < appIN_BUFFER_SIZE - 1 ) )
-					cCommand[xItem++] = cRx;
-			}
+			/* if there is a command received, then go to processing */
+			if( pxSession != NULL )
+				xState_UART = PROCESSING;
+			else
+				xState_UART = bReceiving ? RECEIVING : IDLE;
 			break;
 		case PROCESSING:
-			/* Process command until it finish */
-			if( CLI_ProcessCommand( cCommand, cOutputBuffer, appOUT_BUFFER_SIZE ) )
-			{
-				uartWriteString( UART_USB, cOutputBuffer );
-			}
+			/* One call of one command each time, so the commands in flight take turns.
+			A tagged command that finish soon answer before a slow one received earlier */
+			if( pxSession != NULL )
+				app_SessionRun( pxSession, cOutputBuffer );
 			else
-			{
-				uartWriteString( UART_USB, cOutputBuffer );
-				/* Clean buffers and return to idle */
-				memset( cCommand, 0, appIN_BUFFER_SIZE );
-				memset( cOutputBuffer, 0, appOUT_BUFFER_SIZE );
-				xItem = 0;
-				xState_UART = IDLE;
-			}
+				xState_UART = bReceiving ? RECEIVING : IDLE;
 			break;
 		default:
 			/* Should never enter here but if it does, then print error and reset to idle */
-			memset( cCommand, 0, appIN_BUFFER_SIZE );
-			memset( cOutputBuffer, 0, appOUT_BUFFER_SIZE );
-			xItem = 0;
-			uartWriteString( UART_USB, "ERROR: estado desconocido\r\n\r\n" );
+			app_SessionCancelAll();
+			UART_USBWriteString( "ERROR: estado desconocido\r\n\r\n" );
 			xState_UART = IDLE;
 			break;
 	}
+
+	/* After the answer of "baud", change the rate. Restore it if not confirmed */
+	pcBaudMessage = app_baudUpdate( (uint32_t)tickRead() );
+	if( pcBaudMessage != NULL )
+		UART_USBWriteString( pcBaudMessage );
+
+	if( xState_UART != xPreviousState )
+		traceRECORD( traceEV_STATE, xState_UART );
 }
 /*-----------------------------------------------------------*/
 
 /*=====[Main function, entry point]========================================*/
 
 int main(void) {
-   const tick_t ulxBlink = app_msToTick( 500 );TP
+   const tick_t ulxBlink = app_msToTick( 500 );
    tick_t ulxCurrTick = 0;
    // ---------- Board configuration --------------------
    boardInit();
@@ -169,10 +692,13 @@ int main(void) {
    ulxCurrTick = tickRead();
 
    // ---------- Others configurations ------------------
+   /* Start timestamps of trace */
+   app_traceInit();
    /* Register commands */
    app_commandRegisterCLICommands();
    /* Configure UART_USB */
-   UART_USBConfig();
+   UART_USBConfig( baudDEFAULT_RATE );
+   app_baudInit( UART_USBConfig, baudDEFAULT_RATE, app_msToTick( baudTIMEOUT_MS ) );
    /* Initialize state machine */
    app_FMS_Init();
 
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""
+baud.py
+
+Change the baud rate of the UART_USB command line with the handshake of the
+"baud" command (inc/app_baud.h):
+
+    1. "baud <rate>" is sent and answered at the current rate.
+    2. Both ends change to the new rate.
+    3. The client sends "baud ok" at the new rate, again until the board
+       answers "baud: confirmado". If the confirmation does not arrive within
+       baudTIMEOUT_MS, the board goes back to the previous rate and says so.
+
+Usage:
+    baud.py --port /dev/ttyUSB1 --rate 921600
+    baud.py --simulate ./uartsim                     (no hardware needed)
+
+With --simulate the handshake runs against the firmware (app_baud.c and
+UART_USBConfig of uC.c) on the host UART simulation of tools/uartsim.c, where
+bytes sent at a rate different from the receiver's arrive garbled. It checks
+a confirmed change, a change the client cannot follow (fall back), a
+confirmation lost once (sent again) or always (fall back) on the link, and a
+tagged command sent with "baud", answered at the new rate.
+
+Needs pyserial, except for --simulate.
+"""
+
+import argparse
+import sys
+import time
+
+CONFIRMATION = b"baud ok"
+DEFAULT_RATE = 115200
+BOARD_TIMEOUT = 2.0          # baudTIMEOUT_MS
+CONFIRMATION_RETRY = 0.25    # the board may change later than the client
+
+
+def read_line(uart, timeout):
+    """Return the next line without CR LF, or None on timeout."""
+    deadline = time.monotonic() + timeout
+    line = b""
+    while time.monotonic() < deadline:
+        data = uart.read(1)
+        if not data:
+            continue
+        if data == b"\n":
+            return line.strip(b"\r").decode("utf-8", "replace")
+        line += data
+    return None
+
+
+def confirm(uart, rate, timeout=BOARD_TIMEOUT):
+    """Change to the new rate after the answer of "baud" and confirm it.
+    Return true if the board answered the confirmation."""
+    # The board changes after the answer, give it the time of a few characters
+    time.sleep(0.01)
+    uart.baudrate = rate
+    uart.reset_input_buffer()
+
+    # A confirmation sent before the board changed arrives garbled: repeat it.
+    # Lines received with the noise of the change are answered with an error
+    deadline = time.monotonic() + timeout / 2
+    while time.monotonic() < deadline:
+        # The first newline ends any noise received during the change
+        uart.write(b"\n" + CONFIRMATION + b"\n")
+        retry = min(deadline, time.monotonic() + CONFIRMATION_RETRY)
+        while time.monotonic() < retry:
+            answer = read_line(uart, retry - time.monotonic())
+            if answer is not None and answer.endswith("confirmado"):
+                return True
+    return False
+
+
+def negotiate(uart, rate, timeout=BOARD_TIMEOUT):
+    """Run the handshake. Return the rate in use at the end."""
+    previous = uart.baudrate
+    uart.reset_input_buffer()
+    uart.write(b"baud %d\n" % rate)
+
+    answer = read_line(uart, 1.0)
+    if answer is None or not answer.startswith("baud:") or "->" not in answer:
+        print("answer to baud: %r" % answer, file=sys.stderr)
+        return previous
+
+    if confirm(uart, rate, timeout):
+        return rate
+
+    # Not confirmed: the board goes back on its own, follow it
+    uart.baudrate = previous
+    answer = read_line(uart, timeout + 1.0)
+    print("fall back: %r" % answer, file=sys.stderr)
+    return previous
+
+
+def simulate(program, timeout=BOARD_TIMEOUT):
+    """Run the handshake against the firmware on tools/uartsim.c, through the
+    pseudo terminal of the simulation. Return the number of failures."""
+    import uartsim
+
+    class BridgePort(uartsim.Port):
+        """Port with the limits of a USB bridge: a rate above max_rate is not
+        taken, and the first bytes written after a change can be lost."""
+
+        max_rate = None
+        drop_after_change = 0
+        drop = 0
+
+        @uartsim.Port.baudrate.setter
+        def baudrate(self, rate):
+            if self.max_rate is not None and rate > self.max_rate:
+                return
+            if getattr(self, "_baudrate", rate) != rate:
+                self.drop, self.drop_after_change = self.drop_after_change, 0
+            uartsim.Port.baudrate.fset(self, rate)
+
+        def write(self, data):
+            dropped = min(self.drop, len(data))
+            self.drop -= dropped
+            uartsim.Port.write(self, data[dropped:])
+
+    cases = [
+        # name, max rate of the host bridge, bytes lost, rate asked, rate expected
+        ("confirmed", None, 0, 921600, 921600),
+        ("host cannot follow", 460800, 0, 921600, DEFAULT_RATE),
+        ("confirmation lost", None, 9, 921600, 921600),
+        ("no confirmation", None, 10000, 921600, DEFAULT_RATE),
+    ]
+    failures = 0
+    for name, host_max, drop, rate, expected in cases:
+        BridgePort.max_rate = host_max
+        BridgePort.drop_after_change = drop
+        process, uart = uartsim.start(program, port_class=BridgePort)
+
+        final = negotiate(uart, rate, timeout)
+
+        # Whatever happened, both ends must agree and the line must work
+        uart.write(b"suma 2 3\n")
+        answer = read_line(uart, 0.5)
+        uart.close()
+        board = uartsim.stop(process).get("rate")
+        ok = final == expected and board == uart.baudrate and answer == "5"
+        failures += not ok
+        print("%-20s rate %-8d board %-8s suma -> %-6r %s" % (name, final, board, answer, "PASS" if ok else "FAIL"))
+
+    # Tagged lines sent with "baud", before the change, get their answer at the new rate
+    process, uart = uartsim.start(program)
+    uart.write(b"#1 baud 921600\n#2 suma 2 3\n")
+    answers = [read_line(uart, 1.0)]
+    confirmed = confirm(uart, 921600, timeout)
+    while answers[-1] is not None:
+        answers.append(read_line(uart, 0.5))
+    uart.close()
+    board = uartsim.stop(process).get("rate")
+    ok = confirmed and board == 921600 and "#2 5" in answers
+    failures += not ok
+    print("%-20s rate %-8d board %-8s answers %r %s" % ("pipelined", uart.baudrate, board, answers[:-1],
+                                                         "PASS" if ok else "FAIL"))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", help="serial port of UART_USB")
+    parser.add_argument("--baud", type=int, default=DEFAULT_RATE, help="current rate of the board")
+    parser.add_argument("--rate", type=int, help="new rate")
+    parser.add_argument("--simulate", metavar="UARTSIM", help="run the handshake on the host simulation built from tools/uartsim.c")
+    args = parser.parse_args()
+
+    if args.simulate:
+        return 1 if simulate(args.simulate) else 0
+
+    if not args.port or not args.rate:
+        parser.error("--port and --rate are needed, or --simulate")
+
+    import serial
+
+    with serial.Serial(args.port, args.baud, timeout=0.05) as uart:
+        final = negotiate(uart, args.rate)
+    print("baud: %d" % final)
+    return 0 if final == args.rate else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,397 @@
+/*
+ * clirun.c
+ *
+ *  Offline runner of command files on the host, with the command table of the
+ *  firmware. The file is mapped in memory and split on shards at line
+ *  boundaries. Each shard runs on its own CLI session on a pool of workers,
+ *  and the output of the shards is written in the order of the file.
+ *
+ *  Workers are forked processes, so each session has its own copy of the
+ *  state the commands keep on static variables (motor, modo, help, bench,
+ *  stats). A shard starts with the "motor" and "modo" lines that precede it
+ *  already applied, so its answers are the same than on a single session.
+ *  A file with "stream" runs on one shard: its samples must reach the same
+ *  session. Lines are cut to the input buffer of the board, and blank lines
+ *  are skipped.
+ *
+ *  Build from the root of the repository:
+ *      gcc -O2 -std=gnu99 -DcliMAX_COMMANDS=20 -DcliMAX_NUMBER_LENGTH=80 -Iinc -Itools/host -o clirun \
+ *          tools/clirun.c lib/CLI.c lib/decimal.c lib/fastmath.c \
+ *          src/app_commands.c src/app_stats.c src/app_trace.c src/app_baud.c -lm
+ *
+ *  Usage:
+ *      clirun [-j workers] [-s shards] [-e] file
+ *          -j	workers running at the same time, default one per CPU
+ *          -s	shards, default runSHARDS_PER_WORKER per worker
+ *          -e	write each line before its output
+ */
+
+/*=====[Includes]===========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "CLI.h"
+#include "app_commands.h"
+#include "app_stats.h"
+
+
+/*=====[Definitions and macros]=============================================*/
+
+/* Same sizes than the buffers of uC.c, so lines and answers are cut the same way */
+#ifndef runLINE_SIZE
+	#define runLINE_SIZE			208
+#endif
+#ifndef runOUT_BUFFER_SIZE
+	#define runOUT_BUFFER_SIZE		256
+#endif
+
+#define runSHARDS_PER_WORKER	4			/**< More shards than workers, so a slow shard does not leave the others idle */
+#define runSHARD_BUFFER_SIZE	( 1 << 16 )	/**< stdio buffer of the output of each shard */
+
+#define ETX    0x03     					/**< ASCII end of text */
+
+
+/*=====[Definitions of private data types]==================================*/
+
+/** A range of whole lines of the file, run on its own session */
+typedef struct
+{
+	const char *pcStart;		/**< First byte of the shard */
+	const char *pcEnd;			/**< Byte after the last line of the shard */
+	FILE *pxOutput;				/**< Output of the shard, copied to stdout in order */
+	pid_t xWorker;				/**< Process running the shard, 0 if not started */
+	bool bDone;					/**< Worker finished */
+} runShard_t;
+
+
+/*=====[Private functions declarations]=====================================*/
+
+/*
+ * Return true if the first word of pcLine, null terminated, is pcCommand.
+ */
+static bool prvIsCommand( const char *pcLine, const char *pcCommand );
+
+/*
+ * Copy the line at pcNext as uC.c receives it: only printable characters,
+ * cut to runLINE_SIZE - 1, and an ETX discards what came before it.
+ * @param	pcLine		where the line is copied, null terminated.
+ * @param	pbEtx		set to true if the line had an ETX.
+ * @return	start of the next line.
+ */
+static const char* prvReadLine( const char *pcNext, const char *pcEnd, char *pcLine, bool *pbEtx );
+
+/*
+ * Run one line on the session of this process, as app_LineReceived() does.
+ * @param	pxOutput	where the answer is written, NULL to discard it.
+ */
+static void prvRunLine( const char *pcLine, bool bEtx, FILE *pxOutput, bool bEcho );
+
+/*
+ * Body of a worker: apply the session lines found before the shard, then run it.
+ * @return	exit status of the worker.
+ */
+static int prvRunShard( const runShard_t *pxShard, const char * const *ppcSessionLines, size_t uxSessionLines, const char *pcEnd, bool bEcho );
+
+/*
+ * Copy the output of a finished shard to stdout and release it.
+ */
+static int prvWriteShard( runShard_t *pxShard );
+
+
+/*=====[Private global variables definition]================================*/
+
+/** Commands whose effect lasts for the next lines of the session */
+static const char * const pcSessionCommands[] = { "motor", "modo", NULL };
+
+
+/*=====[Private functions implementation]===================================*/
+
+static bool prvIsCommand( const char *pcLine, const char *pcCommand )
+{
+	size_t uxLength = strlen( pcCommand );
+
+	/* Same check than CLI_ProcessCommand(), not the start of a longer command */
+	return ( strncmp( pcLine, pcCommand, uxLength ) == 0 ) && ( ( pcLine[uxLength] == ' ' ) || ( pcLine[uxLength] == '\0' ) );
+}
+/*-----------------------------------------------------------*/
+
+static const char* prvReadLine( const char *pcNext, const char *pcEnd, char *pcLine, bool *pbEtx )
+{
+	size_t xItem = 0;
+
+	*pbEtx = false;
+
+	for( ; ( pcNext < pcEnd ) && ( *pcNext != '\n' ) ; pcNext++ )
+	{
+		if( *pcNext == ETX )
+		{
+			*pbEtx = true;
+			xItem = 0;
+		}
+		else if( ( *pcNext == '\b' ) && ( xItem > 0 ) )
+			xItem--;
+		else if( isprint( (unsigned char)*pcNext ) && ( xItem < runLINE_SIZE - 1 ) )
+			pcLine[xItem++] = *pcNext;
+	}
+	pcLine[xItem] = '\0';
+
+	return ( pcNext < pcEnd ) ? pcNext + 1 : pcEnd;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRunLine( const char *pcLine, bool bEtx, FILE *pxOutput, bool bEcho )
+{
+	char cOutputBuffer[runOUT_BUFFER_SIZE];
+	int xMore;
+
+	/* ETX leaves stream mode */
+	if( bEtx )
+		app_statsSetStreaming( false );
+
+	if( pcLine[0] == '\0' )
+		return;
+
+	if( bEcho && ( pxOutput != NULL ) )
+		fprintf( pxOutput, "%s\r\n", pcLine );
+
+	/* On stream mode each line is a sample, absorbed without answer */
+	if( app_statsIsStreaming() )
+	{
+		app_statsPushString( pcLine );
+		return;
+	}
+
+	/* Call the command until it has nothing more to write */
+	do
+	{
+		cOutputBuffer[0] = '\0';
+		xMore = CLI_ProcessCommand( pcLine, cOutputBuffer, sizeof( cOutputBuffer ) );
+		if( pxOutput != NULL )
+			fputs( cOutputBuffer, pxOutput );
+	} while( xMore == pdTRUE );
+}
+/*-----------------------------------------------------------*/
+
+static int prvRunShard( const runShard_t *pxShard, const char * const *ppcSessionLines, size_t uxSessionLines, const char *pcEnd, bool bEcho )
+{
+	char cLine[runLINE_SIZE];
+	const char *pcNext;
+	size_t loop;
+	bool bEtx;
+
+	setvbuf( pxShard->pxOutput, NULL, _IOFBF, runSHARD_BUFFER_SIZE );
+
+	/* The session starts as the previous shards left it */
+	for( loop = 0 ; ( loop < uxSessionLines ) && ( ppcSessionLines[loop] < pxShard->pcStart ) ; loop++ )
+	{
+		prvReadLine( ppcSessionLines[loop], pcEnd, cLine, &bEtx );
+		prvRunLine( cLine, bEtx, NULL, false );
+	}
+
+	for( pcNext = pxShard->pcStart ; pcNext < pxShard->pcEnd ; )
+	{
+		pcNext = prvReadLine( pcNext, pxShard->pcEnd, cLine, &bEtx );
+		prvRunLine( cLine, bEtx, pxShard->pxOutput, bEcho );
+	}
+
+	return ( fflush( pxShard->pxOutput ) == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+/*-----------------------------------------------------------*/
+
+static int prvWriteShard( runShard_t *pxShard )
+{
+	char cBuffer[runSHARD_BUFFER_SIZE];
+	size_t uxRead;
+	int xReturn = EXIT_SUCCESS;
+
+	rewind( pxShard->pxOutput );
+	while( ( uxRead = fread( cBuffer, 1, sizeof( cBuffer ), pxShard->pxOutput ) ) > 0 )
+	{
+		if( fwrite( cBuffer, 1, uxRead, stdout ) != uxRead )
+			xReturn = EXIT_FAILURE;
+	}
+
+	fclose( pxShard->pxOutput );
+	pxShard->pxOutput = NULL;
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc, char *argv[] )
+{
+	long lWorkers = sysconf( _SC_NPROCESSORS_ONLN );
+	long lShards = 0;
+	bool bEcho = false;
+	const char **ppcSessionLines = NULL;
+	size_t uxSessionLines = 0, uxSessionCapacity = 0;
+	bool bStream = false;
+	runShard_t *pxShards;
+	const char *pcFile, *pcEnd, *pcLine, *pcNext;
+	char cLine[runLINE_SIZE];
+	bool bEtx;
+	size_t uxStarted = 0, uxRunning = 0, uxWritten = 0, loop;
+	struct stat xStat;
+	int xOption, xFile, xStatus, xReturn = EXIT_SUCCESS;
+	pid_t xWorker;
+
+	while( ( xOption = getopt( argc, argv, "j:s:e" ) ) != -1 )
+	{
+		switch( xOption )
+		{
+			case 'j':	lWorkers = strtol( optarg, NULL, 10 );	break;
+			case 's':	lShards = strtol( optarg, NULL, 10 );	break;
+			case 'e':	bEcho = true;							break;
+			default:
+				fprintf( stderr, "uso: %s [-j workers] [-s shards] [-e] archivo\n", argv[0] );
+				return EXIT_FAILURE;
+		}
+	}
+	if( ( optind != argc - 1 ) || ( lWorkers < 1 ) || ( lShards < 0 ) )
+	{
+		fprintf( stderr, "uso: %s [-j workers] [-s shards] [-e] archivo\n", argv[0] );
+		return EXIT_FAILURE;
+	}
+	if( lShards == 0 )
+		lShards = lWorkers * runSHARDS_PER_WORKER;
+
+	xFile = open( argv[optind], O_RDONLY );
+	if( ( xFile < 0 ) || ( fstat( xFile, &xStat ) != 0 ) )
+	{
+		perror( argv[optind] );
+		return EXIT_FAILURE;
+	}
+	if( xStat.st_size == 0 )
+		return EXIT_SUCCESS;
+
+	pcFile = mmap( NULL, xStat.st_size, PROT_READ, MAP_PRIVATE, xFile, 0 );
+	close( xFile );
+	if( pcFile == MAP_FAILED )
+	{
+		perror( argv[optind] );
+		return EXIT_FAILURE;
+	}
+	pcEnd = pcFile + xStat.st_size;
+	madvise( (void *)pcFile, xStat.st_size, MADV_SEQUENTIAL );
+
+	app_commandRegisterCLICommands();
+
+	/* Find the lines that change the session, and "stream". Each line is read
+	as the session will run it, so an ETX or a backspace do not hide a command */
+	for( pcLine = pcFile ; pcLine < pcEnd ; )
+	{
+		pcNext = prvReadLine( pcLine, pcEnd, cLine, &bEtx );
+
+		for( loop = 0 ; pcSessionCommands[loop] != NULL ; loop++ )
+		{
+			if( !prvIsCommand( cLine, pcSessionCommands[loop] ) )
+				continue;
+			if( uxSessionLines == uxSessionCapacity )
+			{
+				uxSessionCapacity = uxSessionCapacity ? 2 * uxSessionCapacity : 16;
+				ppcSessionLines = realloc( ppcSessionLines, uxSessionCapacity * sizeof( *ppcSessionLines ) );
+				if( ppcSessionLines == NULL )
+				{
+					perror( "realloc" );
+					return EXIT_FAILURE;
+				}
+			}
+			ppcSessionLines[uxSessionLines++] = pcLine;
+		}
+		bStream |= prvIsCommand( cLine, "stream" );
+		pcLine = pcNext;
+	}
+	if( bStream )
+		lShards = 1;
+
+	/* Split on shards of about the same size, each one ends after a newline */
+	pxShards = calloc( lShards, sizeof( runShard_t ) );
+	if( pxShards == NULL )
+	{
+		perror( "calloc" );
+		return EXIT_FAILURE;
+	}
+	for( loop = 0, pcLine = pcFile ; loop < (size_t)lShards ; loop++ )
+	{
+		const char *pcSplit = pcFile + ( ( loop + 1 ) * (size_t)xStat.st_size ) / lShards;
+
+		if( pcSplit < pcLine )
+			pcSplit = pcLine;
+		if( pcSplit < pcEnd )
+		{
+			pcSplit = memchr( pcSplit, '\n', pcEnd - pcSplit );
+			pcSplit = ( pcSplit != NULL ) ? pcSplit + 1 : pcEnd;
+		}
+
+		pxShards[loop].pcStart = pcLine;
+		pxShards[loop].pcEnd = pcSplit;
+		pxShards[loop].pxOutput = tmpfile();
+		if( pxShards[loop].pxOutput == NULL )
+		{
+			perror( "tmpfile" );
+			return EXIT_FAILURE;
+		}
+		pcLine = pcSplit;
+	}
+
+	/* Keep lWorkers shards running, and write the output of the finished ones in order */
+	fflush( stdout );
+	while( uxWritten < (size_t)lShards )
+	{
+		while( ( uxRunning < (size_t)lWorkers ) && ( uxStarted < (size_t)lShards ) )
+		{
+			xWorker = fork();
+			if( xWorker < 0 )
+			{
+				perror( "fork" );
+				return EXIT_FAILURE;
+			}
+			if( xWorker == 0 )
+				_exit( prvRunShard( &pxShards[uxStarted], ppcSessionLines, uxSessionLines, pcEnd, bEcho ) );
+
+			pxShards[uxStarted++].xWorker = xWorker;
+			uxRunning++;
+		}
+
+		xWorker = wait( &xStatus );
+		if( xWorker < 0 )
+		{
+			perror( "wait" );
+			return EXIT_FAILURE;
+		}
+		for( loop = 0 ; loop < uxStarted ; loop++ )
+		{
+			if( pxShards[loop].xWorker == xWorker )
+			{
+				pxShards[loop].bDone = true;
+				uxRunning--;
+				if( !WIFEXITED( xStatus ) || ( WEXITSTATUS( xStatus ) != EXIT_SUCCESS ) )
+				{
+					fprintf( stderr, "shard %lu: falló\n", (unsigned long)loop );
+					xReturn = EXIT_FAILURE;
+				}
+			}
+		}
+
+		while( ( uxWritten < uxStarted ) && pxShards[uxWritten].bDone )
+		{
+			if( prvWriteShard( &pxShards[uxWritten++] ) != EXIT_SUCCESS )
+				xReturn = EXIT_FAILURE;
+		}
+		fflush( stdout );
+	}
+
+	free( pxShards );
+	free( ppcSessionLines );
+	munmap( (void *)pcFile, xStat.st_size );
+
+	return xReturn;
+}
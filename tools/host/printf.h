@@ -0,0 +1,12 @@
+/*
+ * printf.h
+ *
+ *  Host replacement of tinyprintf: the C library already has snprintf.
+ */
+
+#ifndef HOST_PRINTF_H_
+#define HOST_PRINTF_H_
+
+#include <stdio.h>
+
+#endif /* HOST_PRINTF_H_ */
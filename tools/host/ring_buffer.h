@@ -0,0 +1,130 @@
+/*
+ * ring_buffer.h
+ *
+ *  Host replacement of the lpcOpen ring buffer, with the same interface and
+ *  behaviour: the count is a power of 2, head and tail run free and only the
+ *  producer writes head, only the consumer writes tail.
+ */
+
+#ifndef HOST_RING_BUFFER_H_
+#define HOST_RING_BUFFER_H_
+
+/*=====[Includes]=========================================================================*/
+#include <stdint.h>
+#include <string.h>
+
+
+/*=====[Definitions and macros]===========================================================*/
+
+#define RB_VHEAD( rb )		( *(volatile uint32_t *) &( rb )->head )
+#define RB_VTAIL( rb )		( *(volatile uint32_t *) &( rb )->tail )
+
+
+/*=====[Public data types]===============================================================*/
+
+typedef struct
+{
+	void *data;
+	int count;
+	int itemSz;
+	uint32_t head;
+	uint32_t tail;
+} RINGBUFF_T;
+
+
+/*=====[Public functions declarations]===================================================*/
+
+static inline int RingBuffer_Init( RINGBUFF_T *RingBuff, void *buffer, int itemSize, int count )
+{
+	RingBuff->data = buffer;
+	RingBuff->count = count;
+	RingBuff->itemSz = itemSize;
+	RingBuff->head = RingBuff->tail = 0;
+
+	return 1;
+}
+
+static inline int RingBuffer_GetSize( RINGBUFF_T *RingBuff )
+{
+	return RingBuff->count;
+}
+
+static inline int RingBuffer_GetCount( RINGBUFF_T *RingBuff )
+{
+	return RB_VHEAD( RingBuff ) - RB_VTAIL( RingBuff );
+}
+
+static inline int RingBuffer_GetFree( RINGBUFF_T *RingBuff )
+{
+	return RingBuff->count - RingBuffer_GetCount( RingBuff );
+}
+
+static inline int RingBuffer_IsFull( RINGBUFF_T *RingBuff )
+{
+	return RingBuffer_GetCount( RingBuff ) >= RingBuff->count;
+}
+
+static inline int RingBuffer_IsEmpty( RINGBUFF_T *RingBuff )
+{
+	return RB_VHEAD( RingBuff ) == RB_VTAIL( RingBuff );
+}
+
+static inline void RingBuffer_Flush( RINGBUFF_T *RingBuff )
+{
+	RingBuff->head = RingBuff->tail = 0;
+}
+
+static inline int RingBuffer_InsertMult( RINGBUFF_T *RingBuff, const void *data, int num )
+{
+	uint8_t *pucData = RingBuff->data;
+	int xIndex = RB_VHEAD( RingBuff ) & ( RingBuff->count - 1 );
+	int xFree = RingBuffer_GetFree( RingBuff );	/**< Read once, the consumer may take more meanwhile */
+	int xFirst;
+
+	if( num > xFree )
+		num = xFree;
+	if( num <= 0 )
+		return 0;
+
+	/* Up to the end of the storage, then from its start */
+	xFirst = ( num < RingBuff->count - xIndex ) ? num : RingBuff->count - xIndex;
+	memcpy( pucData + xIndex * RingBuff->itemSz, data, xFirst * RingBuff->itemSz );
+	memcpy( pucData, (const uint8_t *) data + xFirst * RingBuff->itemSz, ( num - xFirst ) * RingBuff->itemSz );
+	__atomic_signal_fence( __ATOMIC_RELEASE );
+	RB_VHEAD( RingBuff ) += num;
+
+	return num;
+}
+
+static inline int RingBuffer_Insert( RINGBUFF_T *RingBuff, const void *data )
+{
+	return RingBuffer_InsertMult( RingBuff, data, 1 );
+}
+
+static inline int RingBuffer_PopMult( RINGBUFF_T *RingBuff, void *data, int num )
+{
+	uint8_t *pucData = RingBuff->data;
+	int xIndex = RB_VTAIL( RingBuff ) & ( RingBuff->count - 1 );
+	int xCount = RingBuffer_GetCount( RingBuff );	/**< Read once, the producer may insert more meanwhile */
+	int xFirst;
+
+	if( num > xCount )
+		num = xCount;
+	if( num <= 0 )
+		return 0;
+
+	xFirst = ( num < RingBuff->count - xIndex ) ? num : RingBuff->count - xIndex;
+	__atomic_signal_fence( __ATOMIC_ACQUIRE );
+	memcpy( data, pucData + xIndex * RingBuff->itemSz, xFirst * RingBuff->itemSz );
+	memcpy( (uint8_t *) data + xFirst * RingBuff->itemSz, pucData, ( num - xFirst ) * RingBuff->itemSz );
+	RB_VTAIL( RingBuff ) += num;
+
+	return num;
+}
+
+static inline int RingBuffer_Pop( RINGBUFF_T *RingBuff, void *data )
+{
+	return RingBuffer_PopMult( RingBuff, data, 1 );
+}
+
+#endif /* HOST_RING_BUFFER_H_ */
@@ -0,0 +1,89 @@
+/*
+ * sapi.h
+ *
+ *  Host replacement of the sAPI symbols used by the command modules, to build
+ *  them with tools/clirun.c. Cycles are nanoseconds of the monotonic clock.
+ *  The board, tick and UART functions used by uC.c are implemented by the
+ *  UART simulation of tools/uartsim.c.
+ */
+
+#ifndef HOST_SAPI_H_
+#define HOST_SAPI_H_
+
+/*=====[Includes]=========================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+
+/*=====[Definitions and macros]===========================================================*/
+
+#define SystemCoreClock		1000000000UL		/**< Cycles per second of cyclesCounterRead() */
+
+/* Bits of the FIFO control register of the LPC4337 UART (lpcOpen uart_18xx_43xx.h) */
+#define UART_FCR_FIFO_EN	( 1 << 0 )
+#define UART_FCR_TRG_LEV0	( 0 )				/**< RX interrupt after 1 byte */
+#define UART_FCR_TRG_LEV1	( 1 << 6 )			/**< RX interrupt after 4 bytes */
+#define UART_FCR_TRG_LEV2	( 2 << 6 )			/**< RX interrupt after 8 bytes */
+#define UART_FCR_TRG_LEV3	( 3 << 6 )			/**< RX interrupt after 14 bytes */
+
+#define LPC_USART0			( &xHostUsarts[0] )
+#define LPC_UART1			( &xHostUsarts[1] )
+#define LPC_USART2			( &xHostUsarts[2] )
+#define LPC_USART3			( &xHostUsarts[3] )
+
+
+/*=====[Public data types]===============================================================*/
+
+typedef uint8_t bool_t;
+typedef uint64_t tick_t;
+typedef void ( *callBackFuncPtr_t )( void * );
+
+typedef enum { LEDR, LEDG, LEDB, LED1, LED2, LED3 } gpioMap_t;
+typedef enum { UART_GPIO, UART_485, UART_USB, UART_ENET, UART_232 } uartMap_t;
+typedef enum { UART_RECEIVE, UART_TRANSMITER_FREE } uartEvents_t;
+
+/** Registers of one UART, only to tell them apart */
+typedef struct
+{
+	uint32_t FCR;
+} LPC_USART_T;
+
+
+/*=====[Public global variables declaration]============================================*/
+
+extern LPC_USART_T xHostUsarts[4];
+
+
+/*=====[Public functions declarations]===================================================*/
+
+static inline bool cyclesCounterInit( uint32_t ulClockSpeed )
+{
+	( void ) ulClockSpeed;
+	return true;
+}
+
+static inline uint32_t cyclesCounterRead( void )
+{
+	struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	return (uint32_t)( (uint64_t)xNow.tv_sec * 1000000000ULL + (uint64_t)xNow.tv_nsec );
+}
+
+/* Implemented by tools/uartsim.c */
+void boardInit( void );
+bool_t tickInit( tick_t ulTickRateMS );
+tick_t tickRead( void );
+bool_t gpioToggle( gpioMap_t xPin );
+void uartConfig( uartMap_t xUart, uint32_t ulBaudRate );
+bool_t uartRxReady( uartMap_t xUart );
+uint8_t uartRxRead( uartMap_t xUart );
+bool_t uartTxReady( uartMap_t xUart );
+void uartWriteByte( uartMap_t xUart, const uint8_t ucByte );
+void uartWriteString( uartMap_t xUart, const char *pcString );
+void uartCallbackSet( uartMap_t xUart, uartEvents_t xEvent, callBackFuncPtr_t pxCallback, void *pvParameter );
+void uartInterrupt( uartMap_t xUart, bool_t bEnable );
+void Chip_UART_SetupFIFOS( LPC_USART_T *pxUART, uint32_t ulFCR );
+
+#endif /* HOST_SAPI_H_ */
@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+"""
+loadgen.py
+
+Load generator for the UART_USB command line. Sends "suma" commands with known
+results at a configurable byte rate and burst pattern, and measures sustained
+commands per second, response latency percentiles, commands lost and the
+lines the firmware discarded because rbRxBuffer overflowed (answered with
+"Desborde de recepción").
+
+With --tags each command carries a request tag ("#42 suma 1 2") and the
+answers are matched by tag instead of by order.
+
+The bytes of each burst leave the host back to back at the line baud rate, so
+they arrive to UART_USBOnRx as a train of interrupts; the average rate is set
+with --rate. Up to --window commands are kept in flight without waiting for
+their answer, to stress rbRxBuffer while app_FSM is processing.
+
+To size the buffers, build the firmware with other values, for example adding
+to config.mk:
+    DEFINES+=uartBUFFER_SIZE=64 appIN_BUFFER_SIZE=32 appOUT_BUFFER_SIZE=128
+and run the same load with --label and --csv to collect one row per build.
+The RX FIFO trigger level is selected the same way, e.g.
+    DEFINES+=uartRX_TRIGGER=UART_FCR_TRG_LEV0
+to compare one interrupt per byte against one per burst.
+
+With --simulate the load runs on the host, against the firmware built with
+tools/uartsim.c (build it with the same DEFINES to size the buffers). The
+simulation adds its counters to the results: ring_overruns, the bytes lost
+on rbRxBuffer counted by UART_USBOnRx, fifo_overruns, the bytes lost on the
+RX FIFO, and the interrupts raised by trigger level and by character timeout.
+trigger_level is the one Chip_UART_SetupFIFOS() left on UART_USB, and
+other_fifo_setups counts calls made on another UART. With one byte bursts
+and a low --rate, every line ends under the trigger level and reaches the
+firmware only by the character timeout:
+    loadgen.py --simulate ./uartsim --burst 1 --rate 2000 --count 200
+
+Usage:
+    loadgen.py --port /dev/ttyUSB1 --rate 5000 --burst 16 --window 4 --count 2000
+    loadgen.py --port /dev/ttyUSB1 --label rx16 --csv sizing.csv
+    loadgen.py --simulate ./uartsim --burst 64 --window 8 --tags
+
+Needs pyserial, except for --simulate.
+"""
+
+import argparse
+import collections
+import csv
+import os
+import random
+import sys
+import threading
+import time
+
+ETX = b"\x03"
+OVERRUN = "Desborde de recepción"
+
+
+class Receiver(threading.Thread):
+    """Read lines from the port and keep them with the time they arrived."""
+
+    def __init__(self, uart):
+        super().__init__(daemon=True)
+        self.uart = uart
+        self.lines = collections.deque()
+        self.event = threading.Event()
+        self.running = True
+
+    def run(self):
+        pending = b""
+        while self.running:
+            data = self.uart.read(self.uart.in_waiting or 1)
+            if not data:
+                continue
+            now = time.perf_counter()
+            pending += data
+            while b"\n" in pending:
+                line, pending = pending.split(b"\n", 1)
+                line = line.strip(b"\r")
+                # Error messages end with an empty line
+                if line:
+                    self.lines.append((now, line.decode("utf-8", "replace")))
+                    self.event.set()
+
+
+def percentile(values, p):
+    if not values:
+        return float("nan")
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p * len(values)))]
+
+
+def make_command(rng, tag=None):
+    a = rng.randint(-99999, 99999)
+    b = rng.randint(-99999, 99999)
+    line = "suma %d %d\n" % (a, b)
+    expected = "%g" % (a + b)
+    if tag is not None:
+        # Tagged lines are answered with the same tag, and up to
+        # appPIPELINE_DEPTH of them are in flight on the board
+        line = "#%d %s" % (tag, line)
+        expected = "#%d %s" % (tag, expected)
+    return line.encode("ascii"), expected
+
+
+def run(args):
+    rng = random.Random(args.seed)
+    if args.simulate:
+        import uartsim
+        simulation, uart = uartsim.start(args.simulate, args.baud)
+    else:
+        import serial
+        uart = serial.Serial(args.port, args.baud, timeout=0.05)
+    uart.reset_input_buffer()
+    # Leave any half received command
+    uart.write(ETX)
+    time.sleep(0.1)
+    uart.reset_input_buffer()
+
+    receiver = Receiver(uart)
+    receiver.start()
+
+    outstanding = collections.deque()       # [sent time or None, expected], queued or sent
+    latencies = []
+    ok = failed = lost = overrun_lines = unexpected = 0
+    queued = sent = sent_bytes = 0
+    tx_queue = b""
+    start = time.perf_counter()
+
+    while sent < args.count or outstanding:
+        # Answers arrive in order, or with the tag of their command: match them
+        # with the oldest command sent, or with the one of the same tag
+        while receiver.lines and outstanding and outstanding[0][0] is not None:
+            arrived, line = receiver.lines.popleft()
+            entry = outstanding[0]
+            if args.tags:
+                tag = line.split(" ", 1)[0]
+                entry = next((e for e in outstanding if e[0] is not None and e[1].split(" ", 1)[0] == tag), None)
+                if entry is None:
+                    unexpected += 1
+                    continue
+            outstanding.remove(entry)
+            sent_at, expected = entry
+            latencies.append(arrived - sent_at)
+            if line == expected:
+                ok += 1
+            elif OVERRUN in line:
+                overrun_lines += 1
+            else:
+                failed += 1
+        # More answers than commands: a newline was lost and two commands merged
+        while receiver.lines and not (outstanding and outstanding[0][0] is not None):
+            receiver.lines.popleft()
+            unexpected += 1
+
+        # Oldest command without answer: its newline was lost, resynchronize with ETX
+        if outstanding and outstanding[0][0] is not None and time.perf_counter() - outstanding[0][0] > args.timeout:
+            for sent_at, _ in outstanding:
+                if sent_at is None:
+                    queued -= 1
+                else:
+                    lost += 1
+            outstanding.clear()
+            tx_queue = b""
+            uart.write(ETX)
+
+        # Fill the window
+        while len(outstanding) < args.window and queued < args.count:
+            command, expected = make_command(rng, queued if args.tags else None)
+            tx_queue += command
+            outstanding.append([None, expected])
+            queued += 1
+
+        if not tx_queue:
+            receiver.event.wait(0.01)
+            receiver.event.clear()
+            continue
+
+        # Pace: one burst at line speed, then wait to keep the average rate
+        burst, tx_queue = tx_queue[:args.burst], tx_queue[args.burst:]
+        if args.rate:
+            delay = start + (sent_bytes + len(burst)) / args.rate - time.perf_counter()
+            if delay > 0:
+                time.sleep(delay)
+        uart.write(burst)
+        uart.flush()
+        now = time.perf_counter()
+        sent_bytes += len(burst)
+
+        # A command is sent when its newline leaves
+        newlines = burst.count(b"\n")
+        for entry in outstanding:
+            if newlines == 0:
+                break
+            if entry[0] is None:
+                entry[0] = now
+                sent += 1
+                newlines -= 1
+
+        if args.gap:
+            time.sleep(args.gap / 1000.0)
+
+    elapsed = time.perf_counter() - start
+    receiver.running = False
+    receiver.join()
+    uart.close()
+
+    result = {
+        "label": args.label,
+        "baud": args.baud,
+        "rate": args.rate,
+        "burst": args.burst,
+        "window": args.window,
+        "tags": args.tags,
+        "sent": sent,
+        "ok": ok,
+        "failed": failed,
+        "lost": lost,
+        "overrun_lines": overrun_lines,
+        "unexpected": unexpected,
+        "cmds_per_s": ok / elapsed if elapsed else 0.0,
+        "p50_ms": percentile(latencies, 0.50) * 1000,
+        "p90_ms": percentile(latencies, 0.90) * 1000,
+        "p99_ms": percentile(latencies, 0.99) * 1000,
+        "max_ms": max(latencies) * 1000 if latencies else float("nan"),
+    }
+    if args.simulate:
+        counters = uartsim.stop(simulation)
+        for name in ("ring_overruns", "fifo_overruns", "trigger_level", "trigger_interrupts",
+                     "timeout_interrupts", "max_fifo", "other_fifo_setups"):
+            result[name] = counters.get(name)
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", help="serial port of UART_USB")
+    parser.add_argument("--simulate", metavar="UARTSIM", help="run on the host simulation built from tools/uartsim.c")
+    parser.add_argument("--baud", type=int, default=115200, help="line baud rate")
+    parser.add_argument("--rate", type=float, default=0, help="average bytes per second, 0 for line speed")
+    parser.add_argument("--burst", type=int, default=1, help="bytes written back to back on each burst")
+    parser.add_argument("--gap", type=float, default=0, help="extra pause after each burst, in ms")
+    parser.add_argument("--window", type=int, default=1, help="commands in flight without answer")
+    parser.add_argument("--tags", action="store_true", help="tag each command and match the answers by tag")
+    parser.add_argument("--count", type=int, default=1000, help="commands to send")
+    parser.add_argument("--timeout", type=float, default=1.0, help="seconds to consider a command lost")
+    parser.add_argument("--seed", type=int, default=1, help="seed of the operands")
+    parser.add_argument("--label", default="", help="name of the run, e.g. the buffer sizes of the firmware")
+    parser.add_argument("--csv", help="append the results to this CSV file")
+    args = parser.parse_args()
+    if not args.port and not args.simulate:
+        parser.error("--port or --simulate is required")
+
+    result = run(args)
+
+    for key, value in result.items():
+        print("%-14s %s" % (key, "%.3f" % value if isinstance(value, float) else value))
+
+    if args.csv:
+        new_file = not os.path.exists(args.csv)
+        with open(args.csv, "a", newline="") as output:
+            writer = csv.DictWriter(output, fieldnames=list(result))
+            if new_file:
+                writer.writeheader()
+            writer.writerow(result)
+
+    # On the simulation, bytes left on the FIFO or a FIFO set up on another UART are errors too
+    errors = ("failed", "lost", "overrun_lines", "fifo_overruns", "other_fifo_setups")
+    return 1 if any(result.get(name) for name in errors) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""
+trace2chrome.py
+
+Convert the output of the "trace dump" command to Chrome trace JSON,
+to open it on chrome://tracing or https://ui.perfetto.dev
+
+Usage:
+    trace2chrome.py dump.txt -o trace.json
+    trace2chrome.py --port /dev/ttyUSB1 -o trace.json      (needs pyserial)
+
+Each record of the dump is "tttttttt e aaaa": timestamp in cycles, event
+and argument, all in hexadecimal except the event. Events are defined on
+inc/app_trace.h (Trace_Event_t).
+"""
+
+import argparse
+import json
+import re
+import sys
+
+EV_RX, EV_STATE, EV_CMD_START, EV_CMD_END, EV_TX_START, EV_TX_END, EV_OVERRUN = range(7)
+
+STATES = ["IDLE", "RECEIVING", "PROCESSING"]
+
+TID_RX, TID_FSM, TID_CLI, TID_TX = 1, 2, 3, 4
+TRACKS = {TID_RX: "UART RX", TID_FSM: "app_FSM", TID_CLI: "CLI", TID_TX: "UART TX"}
+
+HEADER = re.compile(r"trace: (\d+) eventos, (\d+) Hz")
+RECORD = re.compile(r"^([0-9a-fA-F]{8}) (\d+) ([0-9a-fA-F]{4})$")
+
+
+def read_port(port, baud):
+    """Send "trace dump" and return the lines until the end mark."""
+    import serial
+
+    lines = []
+    with serial.Serial(port, baud, timeout=2) as uart:
+        uart.write(b"trace dump\n")
+        while True:
+            line = uart.readline().decode("ascii", "replace")
+            if not line:
+                break
+            lines.append(line)
+            if line.startswith("trace: fin"):
+                break
+    return lines
+
+
+def parse(lines, default_clock):
+    """Return the clock and the list of (cycles, event, argument) with unwrapped timestamps."""
+    clock = default_clock
+    records = []
+    absolute = None
+    previous = 0
+
+    for line in lines:
+        line = line.strip()
+        header = HEADER.match(line)
+        if header:
+            clock = int(header.group(2))
+            continue
+        record = RECORD.match(line)
+        if not record:
+            continue
+
+        raw = int(record.group(1), 16)
+        if absolute is None:
+            absolute = 0
+        else:
+            # The cycle counter is 32 bits: take the difference as signed, so it
+            # survives wraps and records written out of order by an interrupt
+            delta = ((raw - previous + (1 << 31)) & 0xFFFFFFFF) - (1 << 31)
+            absolute += delta
+        previous = raw
+        records.append((absolute, int(record.group(2)), int(record.group(3), 16)))
+
+    return clock, records
+
+
+def convert(records, clock, commands):
+    """Return the list of Chrome trace events."""
+    events = [
+        {"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": name}}
+        for tid, name in TRACKS.items()
+    ]
+    open_spans = {}
+
+    def us(cycles):
+        return cycles * 1e6 / clock
+
+    def begin(tid, name, ts, args=None):
+        end(tid, ts)
+        events.append({"name": name, "ph": "B", "pid": 1, "tid": tid, "ts": us(ts), "args": args or {}})
+        open_spans[tid] = name
+
+    def end(tid, ts, args=None):
+        if tid in open_spans:
+            events.append({"name": open_spans.pop(tid), "ph": "E", "pid": 1, "tid": tid, "ts": us(ts), "args": args or {}})
+
+    def command_name(index):
+        return commands[index] if index < len(commands) else "cmd[%d]" % index
+
+    for ts, event, argument in records:
+        if event == EV_RX:
+            char = chr(argument) if 32 <= argument < 127 else "0x%02x" % argument
+            events.append({"name": "rx", "ph": "i", "s": "t", "pid": 1, "tid": TID_RX, "ts": us(ts), "args": {"byte": char}})
+        elif event == EV_OVERRUN:
+            events.append({"name": "overrun", "ph": "i", "s": "g", "pid": 1, "tid": TID_RX, "ts": us(ts), "args": {"byte": argument}})
+        elif event == EV_STATE:
+            state = STATES[argument] if argument < len(STATES) else "state %d" % argument
+            begin(TID_FSM, state, ts)
+        elif event == EV_CMD_START:
+            begin(TID_CLI, command_name(argument), ts)
+        elif event == EV_CMD_END:
+            end(TID_CLI, ts, {"return": argument})
+        elif event == EV_TX_START:
+            begin(TID_TX, "tx", ts, {"bytes": argument})
+        elif event == EV_TX_END:
+            end(TID_TX, ts)
+
+    # Close spans still open at the end of the dump
+    if records:
+        for tid in list(open_spans):
+            end(tid, records[-1][0])
+
+    return events
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", nargs="?", help="file with the output of \"trace dump\" (stdin if omitted)")
+    parser.add_argument("-o", "--output", help="output JSON file (stdout if omitted)")
+    parser.add_argument("--port", help="read the dump directly from this serial port")
+    parser.add_argument("--baud", type=int, default=115200, help="baud rate of --port")
+    parser.add_argument("--clock", type=int, default=204000000, help="cycles per second, if the dump has no header")
+    parser.add_argument("--commands", default="", help="comma separated command names, in registration order, starting with help")
+    args = parser.parse_args()
+
+    if args.port:
+        lines = read_port(args.port, args.baud)
+    elif args.dump:
+        with open(args.dump, encoding="ascii", errors="replace") as dump:
+            lines = dump.readlines()
+    else:
+        lines = sys.stdin.readlines()
+
+    clock, records = parse(lines, args.clock)
+    commands = [name for name in args.commands.split(",") if name]
+    trace = {"traceEvents": convert(records, clock, commands), "displayTimeUnit": "ns"}
+
+    if args.output:
+        with open(args.output, "w") as output:
+            json.dump(trace, output)
+    else:
+        json.dump(trace, sys.stdout)
+
+    print("%d records" % len(records), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
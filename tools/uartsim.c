@@ -0,0 +1,516 @@
+/*
+ * uartsim.c
+ *
+ *  Host simulation of UART_USB, to run the firmware of uC.c unchanged and
+ *  talk to it from tools/loadgen.py and tools/baud.py. The UART is a pseudo
+ *  terminal: its path is written on stdout, and a client opens it as the
+ *  serial port of the board.
+ *
+ *  The bytes written by the client leave on a simulated line, one character
+ *  time (10 bits) each at the rate of the firmware, and arrive to a 16 byte RX
+ *  FIFO. A periodic signal plays the UART interrupt: it preempts the main
+ *  loop, as the interrupt does on the board, and calls the callback of
+ *  uartCallbackSet() when the FIFO reaches the trigger level written with
+ *  Chip_UART_SetupFIFOS(), or when bytes wait 4 character times without new
+ *  ones (character timeout). The answers leave at the same rate, and
+ *  uartWriteString() waits while the 16 byte TX FIFO is full.
+ *  If the rate of the client (the one set on the pseudo terminal) is not the
+ *  rate of the firmware, the bytes arrive garbled on both directions.
+ *
+ *  Cycles and ticks are host time, so "bench" yields on the same 10ms slices
+ *  than on the board, but commands compute faster than on the Cortex-M4. The
+ *  trace takes its timestamps from cyclesCounterRead(), instead of the DWT
+ *  register of the board.
+ *
+ *  On SIGTERM or SIGINT the counters are written on stderr, one "name value"
+ *  per line, and the process ends. ring_overruns is ulRxOverruns, the bytes
+ *  the firmware lost because rbRxBuffer was full.
+ *
+ *  Build from the root of the repository:
+ *      gcc -O2 -std=gnu99 -D_GNU_SOURCE -DappTRACE_ENABLE -DcliTRACE_HOOKS -DcliMAX_COMMANDS=20 -DcliMAX_NUMBER_LENGTH=80 \
+ *          -include sapi.h '-DtraceTIMESTAMP()=cyclesCounterRead()' -Iinc -Itools/host -o uartsim \
+ *          tools/uartsim.c src/uC.c src/app_commands.c src/app_stats.c src/app_trace.c src/app_baud.c \
+ *          lib/CLI.c lib/decimal.c lib/fastmath.c -lm
+ *
+ *  Usage:
+ *      uartsim
+ */
+
+/*=====[Includes]===========================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <sys/time.h>
+#include "sapi.h"
+
+
+/*=====[Definitions and macros]=============================================*/
+
+#define simFIFO_SIZE			16				/**< RX and TX FIFO of the LPC4337 UART */
+#define simLINE_SIZE			4096			/**< Bytes on the line, must be power of 2 */
+#define simBITS_PER_CHAR		10				/**< Start, 8 data, stop */
+#define simTIMEOUT_CHARS		4				/**< Character timeout of the RX FIFO */
+#define simUSB_UART				LPC_USART2		/**< UART of UART_USB on the EDU-CIAA */
+
+#define simMIN_PERIOD_US		10				/**< Period of the interrupt signal */
+#define simMAX_PERIOD_US		100
+
+
+/*=====[Definitions of private data types]==================================*/
+
+/** A byte on the line, with the time it is received */
+typedef struct
+{
+	uint64_t ullAt;				/**< Nanoseconds of the monotonic clock */
+	uint8_t ucByte;
+} simByte_t;
+
+/** One direction of the line */
+typedef struct
+{
+	simByte_t xBytes[simLINE_SIZE];
+	volatile uint32_t ulHead;	/**< Written by the sender */
+	volatile uint32_t ulTail;	/**< Written by the receiver */
+	uint64_t ullFree;			/**< Time the last byte ends */
+} simLine_t;
+
+
+/*=====[Public global variables definition]=====================================*/
+
+LPC_USART_T xHostUsarts[4];
+
+extern volatile uint32_t ulRxOverruns;
+
+
+/*=====[Private global variables definition]====================================*/
+
+static int xMaster = -1;						/**< Side of the simulation of the pseudo terminal */
+static int xSlave = -1;							/**< Kept open, so the client can close and open it again */
+
+static volatile uint32_t ulRate = 115200;		/**< Rate of the firmware */
+static volatile uint64_t ullCharNs;				/**< Nanoseconds of one character at ulRate */
+static uint64_t ullTickNs = 1000000;			/**< Nanoseconds of one tick */
+static uint64_t ullStart;
+
+static simLine_t xRxLine;						/**< Client to firmware */
+static simLine_t xTxLine;						/**< Firmware to client */
+
+static uint8_t ucFifo[simFIFO_SIZE];			/**< RX FIFO */
+static volatile uint32_t ulFifoHead = 0;
+static volatile uint32_t ulFifoTail = 0;
+static uint64_t ullFifoLast = 0;				/**< Last byte received or read, for the character timeout */
+static uint32_t ulTrigger = 1;					/**< RX trigger level */
+
+static callBackFuncPtr_t pxRxCallback = NULL;
+static void *pvRxParameter = NULL;
+static volatile bool bRxInterrupt = false;
+
+/* Counters written on exit */
+static uint32_t ulRxBytes = 0;
+static uint32_t ulTxBytes = 0;
+static uint32_t ulFifoOverruns = 0;			/**< Bytes lost because the RX FIFO was full */
+static uint32_t ulTriggerInterrupts = 0;
+static uint32_t ulTimeoutInterrupts = 0;
+static uint32_t ulMaxFifo = 0;
+static uint32_t ulGarbled = 0;				/**< Bytes sent at a rate different from the receiver's */
+static uint32_t ulOtherFifoSetups = 0;		/**< Chip_UART_SetupFIFOS() on a UART that is not UART_USB */
+
+
+/*=====[Private functions declarations]=====================================*/
+
+/*
+ * Nanoseconds of the monotonic clock.
+ */
+static uint64_t prvNow( void );
+
+/*
+ * Rate set by the client on the pseudo terminal.
+ */
+static uint32_t prvClientRate( void );
+
+/*
+ * Change a byte the way a receiver at another rate reads it.
+ */
+static uint8_t prvGarble( uint8_t ucByte );
+
+/*
+ * Block or unblock the interrupt signal, as disabling the UART interrupt.
+ */
+static void prvInterruptMask( bool bMask );
+
+/*
+ * Program the interrupt signal: a few times per character.
+ */
+static void prvInterruptStart( void );
+
+/*
+ * The UART interrupt: move the bytes of the line to the RX FIFO, call the
+ * callback, and send to the client the answers whose time has come.
+ */
+static void prvInterrupt( int xSignal );
+
+/*
+ * Write the counters and end.
+ */
+static void prvReport( int xSignal );
+
+/*
+ * Open the pseudo terminal before main() of the firmware runs.
+ */
+static void prvStart( void ) __attribute__(( constructor ));
+
+
+/*=====[Private functions implementation]===================================*/
+
+static uint64_t prvNow( void )
+{
+	struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+	return (uint64_t)xNow.tv_sec * 1000000000ULL + (uint64_t)xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvClientRate( void )
+{
+	static const struct { speed_t xSpeed; uint32_t ulRate; } xRates[] =
+	{
+		{ B9600, 9600 }, { B19200, 19200 }, { B38400, 38400 }, { B57600, 57600 },
+		{ B115200, 115200 }, { B230400, 230400 }, { B460800, 460800 }, { B500000, 500000 },
+		{ B921600, 921600 }, { B1000000, 1000000 }, { B1500000, 1500000 }, { B2000000, 2000000 },
+		{ B3000000, 3000000 }, { B4000000, 4000000 },
+	};
+	struct termios xTermios;
+	speed_t xSpeed;
+	size_t loop;
+
+	if( tcgetattr( xSlave, &xTermios ) != 0 )
+		return 0;
+
+	xSpeed = cfgetospeed( &xTermios );
+	for( loop = 0 ; loop < sizeof( xRates ) / sizeof( xRates[0] ) ; loop++ )
+	{
+		if( xRates[loop].xSpeed == xSpeed )
+			return xRates[loop].ulRate;
+	}
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvGarble( uint8_t ucByte )
+{
+	ulGarbled++;
+	return (uint8_t)( ( ucByte * 37 ) ^ 0xA5 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterruptMask( bool bMask )
+{
+	sigset_t xSignals;
+
+	sigemptyset( &xSignals );
+	sigaddset( &xSignals, SIGALRM );
+	sigprocmask( bMask ? SIG_BLOCK : SIG_UNBLOCK, &xSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterruptStart( void )
+{
+	struct itimerval xTimer;
+	uint64_t ullPeriod = ullCharNs / 2000;
+
+	if( ullPeriod < simMIN_PERIOD_US )
+		ullPeriod = simMIN_PERIOD_US;
+	if( ullPeriod > simMAX_PERIOD_US )
+		ullPeriod = simMAX_PERIOD_US;
+
+	xTimer.it_interval.tv_sec = 0;
+	xTimer.it_interval.tv_usec = ullPeriod;
+	xTimer.it_value = xTimer.it_interval;
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterrupt( int xSignal )
+{
+	uint8_t ucData[simLINE_SIZE / 4];
+	uint64_t ullNow = prvNow();
+	uint32_t ulClientRate = prvClientRate();
+	simByte_t *pxByte;
+	ssize_t xRead, loop;
+	uint32_t ulLevel;
+
+	( void ) xSignal;
+
+	/* Bytes written by the client start when the line is free */
+	xRead = read( xMaster, ucData, sizeof( ucData ) );
+	for( loop = 0 ; loop < xRead ; loop++ )
+	{
+		if( xRxLine.ulHead - xRxLine.ulTail >= simLINE_SIZE )
+			break;
+		if( xRxLine.ullFree < ullNow )
+			xRxLine.ullFree = ullNow;
+		xRxLine.ullFree += ullCharNs;
+		pxByte = &xRxLine.xBytes[xRxLine.ulHead & ( simLINE_SIZE - 1 )];
+		pxByte->ullAt = xRxLine.ullFree;
+		pxByte->ucByte = ( ulClientRate == ulRate ) ? ucData[loop] : prvGarble( ucData[loop] );
+		xRxLine.ulHead++;
+	}
+
+	/* Received bytes go to the FIFO, the interrupt is raised when it reaches the trigger level */
+	while( ( xRxLine.ulTail != xRxLine.ulHead ) &&
+		   ( xRxLine.xBytes[xRxLine.ulTail & ( simLINE_SIZE - 1 )].ullAt <= ullNow ) )
+	{
+		pxByte = &xRxLine.xBytes[xRxLine.ulTail & ( simLINE_SIZE - 1 )];
+		xRxLine.ulTail++;
+		ulRxBytes++;
+		ullFifoLast = pxByte->ullAt;
+
+		if( ulFifoHead - ulFifoTail >= simFIFO_SIZE )
+		{
+			ulFifoOverruns++;
+			continue;
+		}
+		ucFifo[ulFifoHead++ & ( simFIFO_SIZE - 1 )] = pxByte->ucByte;
+
+		ulLevel = ulFifoHead - ulFifoTail;
+		if( ulLevel > ulMaxFifo )
+			ulMaxFifo = ulLevel;
+		if( bRxInterrupt && ( pxRxCallback != NULL ) && ( ulLevel >= ulTrigger ) )
+		{
+			ulTriggerInterrupts++;
+			pxRxCallback( pvRxParameter );
+		}
+	}
+
+	/* Character timeout: bytes under the trigger level, and the line quiet */
+	if( bRxInterrupt && ( pxRxCallback != NULL ) && ( ulFifoHead != ulFifoTail ) &&
+		( ullNow - ullFifoLast >= simTIMEOUT_CHARS * ullCharNs ) )
+	{
+		ulTimeoutInterrupts++;
+		pxRxCallback( pvRxParameter );
+	}
+
+	/* Answers reach the client when their last bit leaves */
+	while( ( xTxLine.ulTail != xTxLine.ulHead ) &&
+		   ( xTxLine.xBytes[xTxLine.ulTail & ( simLINE_SIZE - 1 )].ullAt <= ullNow ) )
+	{
+		pxByte = &xTxLine.xBytes[xTxLine.ulTail & ( simLINE_SIZE - 1 )];
+		if( ulClientRate != ulRate )
+			pxByte->ucByte = prvGarble( pxByte->ucByte );
+		if( write( xMaster, &pxByte->ucByte, 1 ) != 1 )
+			break;
+		xTxLine.ulTail++;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( int xSignal )
+{
+	char cReport[512];
+	int xLength;
+
+	( void ) xSignal;
+
+	xLength = snprintf( cReport, sizeof( cReport ),
+			"rate %lu\nrx_bytes %lu\ntx_bytes %lu\nring_overruns %lu\nfifo_overruns %lu\n"
+			"trigger_level %lu\ntrigger_interrupts %lu\ntimeout_interrupts %lu\nmax_fifo %lu\n"
+			"garbled_bytes %lu\nother_fifo_setups %lu\n",
+			(unsigned long)ulRate, (unsigned long)ulRxBytes, (unsigned long)ulTxBytes,
+			(unsigned long)ulRxOverruns, (unsigned long)ulFifoOverruns,
+			(unsigned long)ulTrigger, (unsigned long)ulTriggerInterrupts, (unsigned long)ulTimeoutInterrupts,
+			(unsigned long)ulMaxFifo, (unsigned long)ulGarbled, (unsigned long)ulOtherFifoSetups );
+	if( write( STDERR_FILENO, cReport, xLength ) != xLength )
+		_exit( 1 );
+	_exit( 0 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvStart( void )
+{
+	struct sigaction xAction;
+	struct termios xTermios;
+
+	xMaster = posix_openpt( O_RDWR | O_NOCTTY );
+	if( ( xMaster < 0 ) || ( grantpt( xMaster ) != 0 ) || ( unlockpt( xMaster ) != 0 ) )
+	{
+		perror( "uartsim: posix_openpt" );
+		exit( 1 );
+	}
+	xSlave = open( ptsname( xMaster ), O_RDWR | O_NOCTTY );
+	if( xSlave < 0 )
+	{
+		perror( "uartsim: ptsname" );
+		exit( 1 );
+	}
+	fcntl( xMaster, F_SETFL, fcntl( xMaster, F_GETFL ) | O_NONBLOCK );
+
+	/* A serial port: no echo, no line editing, at the default rate of the board */
+	tcgetattr( xSlave, &xTermios );
+	cfmakeraw( &xTermios );
+	cfsetispeed( &xTermios, B115200 );
+	cfsetospeed( &xTermios, B115200 );
+	tcsetattr( xSlave, TCSANOW, &xTermios );
+
+	ullStart = prvNow();
+	ullCharNs = simBITS_PER_CHAR * 1000000000ULL / ulRate;
+
+	memset( &xAction, 0, sizeof( xAction ) );
+	xAction.sa_handler = prvInterrupt;
+	xAction.sa_flags = SA_RESTART;
+	sigaction( SIGALRM, &xAction, NULL );
+
+	xAction.sa_handler = prvReport;
+	sigaddset( &xAction.sa_mask, SIGALRM );
+	sigaction( SIGTERM, &xAction, NULL );
+	sigaction( SIGINT, &xAction, NULL );
+
+	printf( "%s\n", ptsname( xMaster ) );
+	fflush( stdout );
+}
+
+
+/*=====[Public functions implementation]===================================*/
+
+void boardInit( void )
+{
+}
+/*-----------------------------------------------------------*/
+
+bool_t tickInit( tick_t ulTickRateMS )
+{
+	ullTickNs = ulTickRateMS * 1000000ULL;
+	return true;
+}
+/*-----------------------------------------------------------*/
+
+tick_t tickRead( void )
+{
+	return ( prvNow() - ullStart ) / ullTickNs;
+}
+/*-----------------------------------------------------------*/
+
+bool_t gpioToggle( gpioMap_t xPin )
+{
+	( void ) xPin;
+	return true;
+}
+/*-----------------------------------------------------------*/
+
+void uartConfig( uartMap_t xUart, uint32_t ulBaudRate )
+{
+	if( xUart != UART_USB )
+		return;
+
+	/* sAPI resets the FIFOs and leaves the trigger level on 1 byte */
+	prvInterruptMask( true );
+	ulRate = ulBaudRate;
+	ullCharNs = simBITS_PER_CHAR * 1000000000ULL / ulRate;
+	ulFifoTail = ulFifoHead;
+	ulTrigger = 1;
+	bRxInterrupt = false;
+	prvInterruptMask( false );
+
+	prvInterruptStart();
+}
+/*-----------------------------------------------------------*/
+
+void Chip_UART_SetupFIFOS( LPC_USART_T *pxUART, uint32_t ulFCR )
+{
+	static const uint32_t ulLevels[] = { 1, 4, 8, 14 };
+
+	pxUART->FCR = ulFCR;
+	if( pxUART != simUSB_UART )
+	{
+		ulOtherFifoSetups++;
+		return;
+	}
+
+	prvInterruptMask( true );
+	ulTrigger = ( ulFCR & UART_FCR_FIFO_EN ) ? ulLevels[( ulFCR >> 6 ) & 3] : 1;
+	prvInterruptMask( false );
+}
+/*-----------------------------------------------------------*/
+
+bool_t uartRxReady( uartMap_t xUart )
+{
+	return ( xUart == UART_USB ) && ( ulFifoHead != ulFifoTail );
+}
+/*-----------------------------------------------------------*/
+
+uint8_t uartRxRead( uartMap_t xUart )
+{
+	if( !uartRxReady( xUart ) )
+		return 0;
+
+	ullFifoLast = prvNow();
+	return ucFifo[ulFifoTail++ & ( simFIFO_SIZE - 1 )];
+}
+/*-----------------------------------------------------------*/
+
+bool_t uartTxReady( uartMap_t xUart )
+{
+	( void ) xUart;
+
+	/* TX FIFO empty: only the byte on the shift register is left */
+	return xTxLine.ullFree <= prvNow() + ullCharNs;
+}
+/*-----------------------------------------------------------*/
+
+void uartWriteByte( uartMap_t xUart, const uint8_t ucByte )
+{
+	simByte_t *pxByte;
+	uint64_t ullNow;
+
+	if( xUart != UART_USB )
+		return;
+
+	/* Wait while the TX FIFO is full, or the line keeps more bytes than the client took */
+	do
+	{
+		ullNow = prvNow();
+	} while( ( xTxLine.ullFree > ullNow + simFIFO_SIZE * ullCharNs ) ||
+			 ( xTxLine.ulHead - xTxLine.ulTail >= simLINE_SIZE ) );
+
+	if( xTxLine.ullFree < ullNow )
+		xTxLine.ullFree = ullNow;
+	xTxLine.ullFree += ullCharNs;
+	pxByte = &xTxLine.xBytes[xTxLine.ulHead & ( simLINE_SIZE - 1 )];
+	pxByte->ullAt = xTxLine.ullFree;
+	pxByte->ucByte = ucByte;
+	__atomic_signal_fence( __ATOMIC_RELEASE );
+	xTxLine.ulHead++;
+	ulTxBytes++;
+}
+/*-----------------------------------------------------------*/
+
+void uartWriteString( uartMap_t xUart, const char *pcString )
+{
+	while( *pcString != '\0' )
+		uartWriteByte( xUart, (uint8_t)*pcString++ );
+}
+/*-----------------------------------------------------------*/
+
+void uartCallbackSet( uartMap_t xUart, uartEvents_t xEvent, callBackFuncPtr_t pxCallback, void *pvParameter )
+{
+	if( ( xUart != UART_USB ) || ( xEvent != UART_RECEIVE ) )
+		return;
+
+	prvInterruptMask( true );
+	pxRxCallback = pxCallback;
+	pvRxParameter = pvParameter;
+	prvInterruptMask( false );
+}
+/*-----------------------------------------------------------*/
+
+void uartInterrupt( uartMap_t xUart, bool_t bEnable )
+{
+	if( xUart == UART_USB )
+		bRxInterrupt = bEnable;
+}
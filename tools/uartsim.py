@@ -0,0 +1,96 @@
+"""
+uartsim.py
+
+Client side of tools/uartsim.c, the host simulation of UART_USB that runs the
+firmware of uC.c. Used by loadgen.py and baud.py with --simulate.
+
+start() runs the simulation and returns it with a Port on its pseudo
+terminal, with the part of the pyserial interface the tools use, so the
+simulation needs no pyserial. stop() ends the simulation and returns its
+counters, e.g. "ring_overruns": bytes the firmware lost because rbRxBuffer
+was full (ulRxOverruns).
+"""
+
+import os
+import select
+import signal
+import subprocess
+import termios
+import time
+import tty
+
+RATES = {
+    9600: termios.B9600, 19200: termios.B19200, 38400: termios.B38400, 57600: termios.B57600,
+    115200: termios.B115200, 230400: termios.B230400, 460800: termios.B460800,
+    500000: termios.B500000, 921600: termios.B921600, 1000000: termios.B1000000,
+    1500000: termios.B1500000, 2000000: termios.B2000000, 3000000: termios.B3000000,
+    4000000: termios.B4000000,
+}
+
+
+class Port:
+    """Pseudo terminal with the methods of serial.Serial used by the tools."""
+
+    def __init__(self, path, baudrate, timeout):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        self.timeout = timeout
+        self.baudrate = baudrate
+
+    @property
+    def baudrate(self):
+        return self._baudrate
+
+    @baudrate.setter
+    def baudrate(self, rate):
+        if rate not in RATES:
+            raise ValueError("rate not supported by the pseudo terminal: %d" % rate)
+        attributes = termios.tcgetattr(self.fd)
+        attributes[4] = attributes[5] = RATES[rate]
+        termios.tcsetattr(self.fd, termios.TCSANOW, attributes)
+        self._baudrate = rate
+
+    @property
+    def in_waiting(self):
+        readable, _, _ = select.select([self.fd], [], [], 0)
+        return 4096 if readable else 0
+
+    def read(self, size=1):
+        readable, _, _ = select.select([self.fd], [], [], self.timeout)
+        return os.read(self.fd, size) if readable else b""
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def flush(self):
+        termios.tcdrain(self.fd)
+
+    def reset_input_buffer(self):
+        termios.tcflush(self.fd, termios.TCIFLUSH)
+
+    def close(self):
+        os.close(self.fd)
+
+
+def start(program, baudrate=115200, timeout=0.05, port_class=Port):
+    """Run the simulation. Return the process and a Port on its UART_USB."""
+    process = subprocess.Popen([program], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    path = process.stdout.readline().decode().strip()
+    if not path:
+        raise RuntimeError("%s did not start: %s" % (program, process.stderr.read().decode()))
+    port = port_class(path, baudrate, timeout)
+    # Let main() configure the UART
+    time.sleep(0.05)
+    return process, port
+
+
+def stop(process):
+    """End the simulation and return its counters."""
+    process.send_signal(signal.SIGTERM)
+    _, errors = process.communicate()
+    counters = {}
+    for line in errors.decode().splitlines():
+        name, _, value = line.partition(" ")
+        if value.isdigit():
+            counters[name] = int(value)
+    return counters